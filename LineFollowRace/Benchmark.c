@@ -0,0 +1,239 @@
+// Benchmark.c
+// Runs on MSP432
+// Cycle benchmarks for the hot paths, timed with the DWT
+// cycle counter.  Every candidate is also compared against
+// its reference over the full input range, so a speedup
+// that changes a result shows up in the Errors count.
+
+#include <stdint.h>
+#include "CortexM.h"
+#include "Reflectance.h"
+#include "Fixed.h"
+#include "Event.h"
+#include "Tach.h"
+#include "Odometry.h"
+#include "Curve.h"
+#include "Benchmark.h"
+
+struct Benchmark_Result Benchmark_Results[BENCH_COUNT];
+
+static volatile int32_t Sink;   // keeps the timed calls from being optimized away
+static uint32_t Overhead;       // cycles of an empty measurement
+
+#define VECTORS 256             // 8-channel inputs per Fixed benchmark
+static const int16_t Extreme[8] = {FIXED_MIN, FIXED_MIN+1, -1, 0, 1, 256, FIXED_MAX-1, FIXED_MAX};
+static uint32_t Seed;
+
+// ------------start------------
+// Clear a result before timing.
+static void start(enum Benchmark_Id id){
+  Benchmark_Results[id].Min = 0xFFFFFFFF;
+  Benchmark_Results[id].Max = 0;
+  Benchmark_Results[id].Total = 0;
+  Benchmark_Results[id].Calls = 0;
+  Benchmark_Results[id].Errors = 0;
+}
+
+// ------------record------------
+// Add one timed call to a result.
+// Input: id which benchmark
+//        cycles elapsed cycles including Overhead
+static void record(enum Benchmark_Id id, uint32_t cycles){
+  struct Benchmark_Result *r = &Benchmark_Results[id];
+  cycles = (cycles > Overhead) ? cycles - Overhead : 0;
+  if(cycles < r->Min) r->Min = cycles;
+  if(cycles > r->Max) r->Max = cycles;
+  r->Total += cycles;
+  r->Calls++;
+}
+
+// ------------position------------
+// Time one Reflectance_Position variant over all 256
+// inputs and count mismatches against the reference.
+static void position(enum Benchmark_Id id, int32_t (*fn)(uint8_t)){
+  uint32_t data, t0, t1;
+  int32_t result;
+  start(id);
+  for(data = 0; data < 256; data++){
+    t0 = CycleCounter_Read();
+    result = fn((uint8_t)data);
+    t1 = CycleCounter_Read();
+    record(id, t1 - t0);
+    Sink = result;
+    if(result != Reflectance_PositionRef((uint8_t)data)){
+      Benchmark_Results[id].Errors++;
+    }
+  }
+}
+
+// ------------vector------------
+// Fill 8 lanes from a linear congruential generator, every
+// fourth vector from the saturation corner cases instead.
+static void vector(int16_t v[8], uint32_t n){
+  int i;
+  for(i = 0; i < 8; i++){
+    Seed = 1664525*Seed + 1013904223;
+    v[i] = (n&3) ? (int16_t)(Seed>>16) : Extreme[(Seed>>16)&7];
+  }
+}
+
+// ------------dot8------------
+// Time Fixed_Dot8 and Fixed_Dot8C on the same inputs; any
+// difference counts as an error against the SIMD version.
+static void dot8(void){
+  int16_t x[8], w[8];
+  uint32_t n, t0, t1;
+  int32_t simd, ref;
+  start(BENCH_DOT8_C);
+  start(BENCH_DOT8);
+  Seed = 1;
+  for(n = 0; n < VECTORS; n++){
+    vector(x, n);
+    vector(w, n);
+    t0 = CycleCounter_Read();
+    ref = Fixed_Dot8C(x, w);
+    t1 = CycleCounter_Read();
+    record(BENCH_DOT8_C, t1 - t0);
+    t0 = CycleCounter_Read();
+    simd = Fixed_Dot8(x, w);
+    t1 = CycleCounter_Read();
+    record(BENCH_DOT8, t1 - t0);
+    Sink = ref + simd;
+    if(simd != ref){
+      Benchmark_Results[BENCH_DOT8].Errors++;
+    }
+  }
+}
+
+// ------------normalize8------------
+// Time Fixed_Normalize8 and Fixed_Normalize8C on the same
+// inputs and compare all eight outputs.
+static void normalize8(void){
+  int16_t x[8], offset[8], gain[8], ref[8], simd[8];
+  uint32_t n, t0, t1;
+  int i;
+  start(BENCH_NORMALIZE8_C);
+  start(BENCH_NORMALIZE8);
+  Seed = 2;
+  for(n = 0; n < VECTORS; n++){
+    vector(x, n);
+    vector(offset, n);
+    vector(gain, n);
+    t0 = CycleCounter_Read();
+    Fixed_Normalize8C(x, offset, gain, ref);
+    t1 = CycleCounter_Read();
+    record(BENCH_NORMALIZE8_C, t1 - t0);
+    t0 = CycleCounter_Read();
+    Fixed_Normalize8(x, offset, gain, simd);
+    t1 = CycleCounter_Read();
+    record(BENCH_NORMALIZE8, t1 - t0);
+    for(i = 0; i < 8; i++){
+      if(simd[i] != ref[i]){
+        Benchmark_Results[BENCH_NORMALIZE8].Errors++;
+      }
+    }
+  }
+}
+
+// ------------eventPut------------
+// Time Event_Put from empty until past full, so both the
+// claim and the overflow paths are in Max.  The uncontended
+// claim takes one pass; each ISR that preempts a producer
+// between its LDREX and STREX adds one more pass.  Errors
+// counts events that came back wrong or out of order.
+static void eventPut(void){
+  uint32_t n, t0, t1, event;
+  start(BENCH_EVENT_PUT);
+  Event_Init();
+  for(n = 0; n < EVENT_SIZE + 8; n++){
+    t0 = CycleCounter_Read();
+    Event_Put(EVENT(EVENT_SENSOR, n));
+    t1 = CycleCounter_Read();
+    record(BENCH_EVENT_PUT, t1 - t0);
+  }
+  for(n = 0; Event_Get(&event); n++){
+    if((EVENT_TYPE(event) != EVENT_SENSOR) || (EVENT_DATA(event) != n)){
+      Benchmark_Results[BENCH_EVENT_PUT].Errors++;
+    }
+  }
+  if((n != EVENT_SIZE) || (Event_GetStats()->Lost[EVENT_SENSOR] != 8)){
+    Benchmark_Results[BENCH_EVENT_PUT].Errors++;
+  }
+  Event_Init();                  // leave it empty for the application
+}
+
+// ------------odometry------------
+// Time Odometry_Update over a quarter circle of 500 mm
+// radius in 5 mm steps, the wheels 140 mm apart.  Errors
+// counts an end pose more than 1% of the radius or 1 degree
+// away from (500, 500) mm facing 90 degrees.
+static void odometry(void){
+  uint32_t n, t0, t1;
+  int32_t left, right;
+  const struct Odometry_Pose *p = Odometry_Get();
+  start(BENCH_ODOMETRY);
+  Odometry_Init(0, 0);
+  for(n = 1; n <= 157; n++){     // 157*5 mm is a quarter of 3142 mm
+    left = n*5*430/500*1000/TACH_UM_PER_EDGE;
+    right = n*5*570/500*1000/TACH_UM_PER_EDGE;
+    t0 = CycleCounter_Read();
+    Odometry_Update(left, right);
+    t1 = CycleCounter_Read();
+    record(BENCH_ODOMETRY, t1 - t0);
+  }
+  if((p->X < 495000) || (p->X > 505000) || (p->Y < 495000) || (p->Y > 505000) ||
+     (p->Heading < 0x3F49F49F) || (p->Heading > 0x40B60B61)){   // 89 to 91 degrees
+    Benchmark_Results[BENCH_ODOMETRY].Errors++;
+  }
+  Odometry_Init(Tach_Count(TACH_LEFT), Tach_Count(TACH_RIGHT));   // leave it for the application
+}
+
+// ------------curve------------
+// Time Curve_Step on positions along a parabola, 300 um
+// per step plus 20 um per step squared, at 10 ms and
+// 300 mm/s.  The fit is exact for a parabola, so Errors
+// counts any estimate off by more than 1: the slope in
+// mm/s, 400 mm/s^2 and 4444/km (3 mm per step).
+static void curve(void){
+  const struct Curve_Estimate *e = Curve_Get();
+  int32_t k, b;
+  uint32_t t0, t1;
+  start(BENCH_CURVE);
+  Curve_Init();
+  for(k = -20; k <= 20; k++){
+    t0 = CycleCounter_Read();
+    Curve_Step(10000, 300, 300*k + 20*k*k - 5000);
+    t1 = CycleCounter_Read();
+    if(e->Count < CURVE_N){
+      continue;                  // filling the history, not a full fit
+    }
+    record(BENCH_CURVE, t1 - t0);
+    b = (300 + 40*k)/10;
+    if((e->Slope < b-1) || (e->Slope > b+1) || (e->Accel < 399) || (e->Accel > 401) ||
+       (e->Bend < 4443) || (e->Bend > 4445)){
+      Benchmark_Results[BENCH_CURVE].Errors++;
+    }
+  }
+  Curve_Init();                  // leave it empty for the application
+}
+
+// ------------Benchmark_Run------------
+// Run every benchmark once.
+// Input: none
+// Output: none, results in Benchmark_Results[]
+void Benchmark_Run(void){
+  uint32_t t0, t1;
+  CycleCounter_Init();
+  t0 = CycleCounter_Read();
+  t1 = CycleCounter_Read();
+  Overhead = t1 - t0;
+
+  position(BENCH_POSITION_REF, Reflectance_PositionRef);
+  position(BENCH_POSITION_TABLE, Reflectance_Position);
+  position(BENCH_POSITION_POPCOUNT, Reflectance_PositionPopcount);
+  dot8();
+  normalize8();
+  eventPut();
+  odometry();
+  curve();
+}
@@ -0,0 +1,65 @@
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+/**
+ * @file      Benchmark.h
+ * @brief     On-target cycle benchmarks
+ * @details   Times candidate implementations with the DWT cycle counter
+ * and checks each one against its reference.  Results are left in
+ * Benchmark_Results[] to be read with the debugger.<br>
+ * Build with BENCHMARK defined to have main() run Benchmark_Run()
+ * once after initialization.
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup MSP432
+ * @brief
+ * @{*/
+
+/**
+ * \brief index of each benchmark in Benchmark_Results[]
+ */
+enum Benchmark_Id {
+  BENCH_POSITION_REF,        // Reflectance_PositionRef, loops and divide
+  BENCH_POSITION_TABLE,      // Reflectance_Position, 256-entry table
+  BENCH_POSITION_POPCOUNT,   // Reflectance_PositionPopcount
+  BENCH_DOT8_C,              // Fixed_Dot8C, portable
+  BENCH_DOT8,                // Fixed_Dot8, DSP instructions
+  BENCH_NORMALIZE8_C,        // Fixed_Normalize8C, portable
+  BENCH_NORMALIZE8,          // Fixed_Normalize8, DSP instructions
+  BENCH_EVENT_PUT,           // Event_Put, including onto a full queue
+  BENCH_ODOMETRY,            // Odometry_Update, one control step
+  BENCH_CURVE,               // Curve_Step, one control step with a full history
+  BENCH_COUNT
+};
+
+/**
+ * Cycle counts for one benchmark, overhead of the
+ * measurement itself already subtracted
+ */
+struct Benchmark_Result {
+  uint32_t Min;       // fastest call
+  uint32_t Max;       // slowest call
+  uint32_t Total;     // sum over all calls
+  uint32_t Calls;     // number of calls timed
+  uint32_t Errors;    // results that differ from the reference
+};
+
+/**
+ * \brief results of the last Benchmark_Run(), indexed by Benchmark_Id
+ */
+extern struct Benchmark_Result Benchmark_Results[BENCH_COUNT];
+
+/**
+ * Run every benchmark once and fill in Benchmark_Results[].
+ * Takes over the CPU while it runs; do not call while driving.
+ * @param  none
+ * @return none
+ * @note   Assumes Clock_Init48MHz() and Reflectance_Init() have been called
+ * @brief  Run the cycle benchmarks
+ */
+void Benchmark_Run(void);
+
+#endif /* BENCHMARK_H_ */
@@ -0,0 +1,38 @@
+// Boot.c
+// Runs on MSP432
+// Times each part of startup from main() to the first
+// motor command, using the cycle counter and whichever
+// clock rate was running between marks.
+
+#include <stdint.h>
+#include "Clock.h"
+#include "CortexM.h"
+#include "Boot.h"
+
+static uint32_t Us[BOOT_PHASES];  // end of each phase, us after BOOT_MAIN
+static uint32_t Marked;           // bit n set once phase n is marked
+static uint32_t LastCycles;       // cycle counter at the previous mark
+static uint32_t LastUs;
+static uint32_t LastMHz;          // core clock rate since the previous mark
+
+// ------------Boot_Mark------------
+void Boot_Mark(enum Boot_Phase phase){
+  uint32_t now = CycleCounter_Read();
+  if(Marked&(1<<phase)){
+    return;
+  }
+  if(phase == BOOT_MAIN){
+    LastUs = 0;
+  }else{
+    LastUs = LastUs + (now - LastCycles)/LastMHz;
+  }
+  Us[phase] = LastUs;
+  Marked |= 1<<phase;
+  LastCycles = now;
+  LastMHz = Clock_GetFreq()/1000000;
+}
+
+// ------------Boot_Us------------
+uint32_t Boot_Us(enum Boot_Phase phase){
+  return Us[phase];
+}
@@ -0,0 +1,54 @@
+#ifndef BOOT_H_
+#define BOOT_H_
+
+/**
+ * @file      Boot.h
+ * @brief     Boot-to-first-motion timing
+ * @details   main() marks the end of each part of initialization with
+ * Boot_Mark(), and the control task marks its first Motor_Forward().
+ * The marks are cycle counter readings converted to microseconds at
+ * the clock rate in effect since the previous mark, so the phases
+ * before and after the switch to 48 MHz are both timed correctly.
+ * Time is counted from the BOOT_MAIN mark; the C startup that runs
+ * between reset and main() is not included.
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup MSP432
+ * @brief
+ * @{*/
+
+/**
+ * Points in startup, in the order main() reaches them
+ */
+enum Boot_Phase {
+  BOOT_MAIN,          // main() entered, time zero
+  BOOT_CLOCK_START,   // crystal and VCORE1 requested
+  BOOT_GPIO,          // pins set up while the clock settles
+  BOOT_CLOCK,         // running at 48 MHz
+  BOOT_DRIVERS,       // everything else initialized
+  BOOT_LAUNCH,        // kernel about to start
+  BOOT_MOTION,        // first Motor_Forward() from a sensor reading
+  BOOT_PHASES
+};
+
+/**
+ * Record the time a phase ended.  Later marks of the same phase are
+ * ignored, so a mark may sit in a loop.
+ * @param  phase the phase that just ended
+ * @return none
+ * @note   Assumes CycleCounter_Init() has been called
+ * @brief  Mark a phase
+ */
+void Boot_Mark(enum Boot_Phase phase);
+
+/**
+ * @param  phase any phase
+ * @return microseconds from BOOT_MAIN to the end of phase, 0 if not reached yet
+ * @brief  Time of a phase
+ */
+uint32_t Boot_Us(enum Boot_Phase phase);
+
+#endif /* BOOT_H_ */
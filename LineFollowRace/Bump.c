@@ -8,17 +8,24 @@
 
 
 #include "Bump.h"
+#include "Event.h"
+#include "Trace.h"
 
 
 void BumpInt_Init(void){
     P4->IE |= 0xED; //Enabling interrupts for bump pins on port 4
-    P4->IES |= 0xED;   //Enabling rising edge interrupt bump pins (I think)
+    P4->IES |= 0xED;   //Falling edge: pins are pulled up and a press pulls them low
     P4->IFG &= ~0xED; //Clearing interrupt flag
-    //P4->IV |= 0x0F; //Setting interrupt to low priority (not sure if this is a mistake, or what "low" implies)
+    NVIC_SetPriority(PORT4_IRQn, 2);  //Above UART0 and the kernel, below the control timers
+    NVIC_EnableIRQ(PORT4_IRQn);
 }
 
+// Acknowledge the edges and post the switch state to the control task
 void PORT4_IRQHandler(void){
-    //Do something on interrupt
+    TRACE_BEGIN(TRACE_BUMP);
+    P4->IFG &= ~0xED;
+    Event_Put(EVENT(EVENT_BUMP, Bump_Read()));
+    TRACE_END(TRACE_BUMP);
 }
 
 // Initialize Bump sensors
@@ -28,7 +35,7 @@ void PORT4_IRQHandler(void){
 void Bump_Init(void){
     P4-> SEL0 &= ~0xED; //Initializing P4 bumper pins
     P4-> SEL1 &= ~0xED;
-    P4-> DIR |= 0xED;
+    P4-> DIR &= ~0xED; //Inputs
     P4-> REN |= 0xED; //Enabling pull-up resistors
     P4-> OUT |= 0xED;
 }
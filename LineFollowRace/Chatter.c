@@ -0,0 +1,163 @@
+// Chatter.c
+// Runs on MSP432
+// Finds periodic cycles in the FSM's states, keeps dwell and
+// flip counts per lap, and holds back changes of steering
+// state that too few recent steps agree with.
+
+#include <stdint.h>
+#include "Chatter.h"
+
+#define RUNS (2*CHATTER_PERIODS) // a cycle must be seen twice
+#define NONE 0xFF                // no state asked for yet
+
+static struct Chatter_Stats Current, Last;
+static uint8_t Window;           // M, 0 for no filter
+static uint8_t Need;             // N as set
+static uint8_t Agree;            // N in use, Need or more while cycling
+static uint8_t Adapt;
+static uint8_t Asked[CHATTER_WINDOW];   // states asked for, newest at Put-1
+static uint8_t Put;
+static uint8_t RunState[RUNS];   // committed runs, newest first
+static uint32_t RunStart[RUNS];  // ms each run began
+static uint8_t NumRuns;
+static uint32_t LastMs;          // time of the previous step
+static uint32_t Calm;            // ms of the last cycle or decrease of Agree
+
+// ------------clear------------
+static void clear(struct Chatter_Stats *s){
+  uint8_t i;
+  s->Ms = s->Steps = s->Asked = s->Flips = s->Cycles = 0;
+  s->Period = 0;
+  s->CycleMs = 0;
+  for(i = 0; i < CHATTER_STATES; i++){
+    s->Dwell[i] = 0;
+    s->Runs[i] = 0;
+  }
+}
+
+// ------------run------------
+// Start a run of state and look for a cycle ending with it.
+// Input: ms time now
+//        state state committed
+static void run(uint32_t ms, uint8_t state){
+  uint8_t i, p;
+  for(i = RUNS-1; i > 0; i--){
+    RunState[i] = RunState[i-1];
+    RunStart[i] = RunStart[i-1];
+  }
+  RunState[0] = state;
+  RunStart[0] = ms;
+  if(NumRuns < RUNS){
+    NumRuns++;
+  }
+  Current.Runs[state]++;
+  for(p = 2; 2*p <= NumRuns; p++){
+    for(i = 0; (i < p) && (RunState[i] == RunState[i+p]); i++){
+    }
+    if(i == p){                  // the last p runs repeat the p before them
+      if(ms - RunStart[p] <= CHATTER_CYCLE_MS){
+        Current.Cycles++;
+        Current.Period = p;
+        Current.CycleMs = ms - RunStart[p];
+        if(Adapt && (Agree < Window)){
+          Agree++;
+        }
+        Calm = ms;
+      }
+      return;                    // shortest period only
+    }
+  }
+}
+
+// ------------Chatter_Set------------
+void Chatter_Set(uint8_t m, uint8_t n, uint8_t adapt){
+  if(m > CHATTER_WINDOW){
+    m = CHATTER_WINDOW;
+  }
+  if(n > m){
+    n = m;
+  }
+  if(n == 0){
+    n = 1;
+  }
+  if((m == Window) && (n == Need) && (adapt == Adapt)){
+    return;
+  }
+  Window = m;
+  Need = n;
+  Adapt = adapt;
+  Agree = n;
+}
+
+// ------------Chatter_Init------------
+void Chatter_Init(uint8_t m, uint8_t n, uint8_t adapt){
+  uint8_t i;
+  clear(&Current);
+  clear(&Last);
+  for(i = 0; i < CHATTER_WINDOW; i++){
+    Asked[i] = NONE;
+  }
+  Put = 0;
+  NumRuns = 0;
+  Window = Need = Adapt = 0xFF;  // so Chatter_Set takes the values
+  Chatter_Set(m, n, adapt);
+}
+
+// ------------Chatter_Step------------
+// Input: ms time now
+//        state state the FSM is in
+//        asked state its table asks for
+// Output: state to go to
+uint8_t Chatter_Step(uint32_t ms, uint8_t state, uint8_t asked){
+  uint8_t i, votes, next = asked;
+  if(NumRuns){
+    Current.Dwell[state] += ms - LastMs;
+    Current.Ms += ms - LastMs;
+  }
+  if((NumRuns == 0) || (RunState[0] != state)){
+    run(ms, state);              // first step, or moved by the caller (Stop)
+  }
+  LastMs = ms;
+  Current.Steps++;
+  Asked[Put] = asked;
+  Put = (Put + 1)%CHATTER_WINDOW;
+  if(asked != state){
+    Current.Asked++;
+    if(Window && (state < CHATTER_STEER) && (asked < CHATTER_STEER)){
+      votes = 0;
+      for(i = 1; i <= Window; i++){
+        if(Asked[(Put + CHATTER_WINDOW - i)%CHATTER_WINDOW] == asked){
+          votes++;
+        }
+      }
+      if(votes < Agree){
+        next = state;            // not enough agreement yet
+      }
+    }
+  }
+  if(next != state){
+    Current.Flips++;
+    run(ms, next);
+  }
+  if((Agree > Need) && (ms - Calm >= CHATTER_DECAY_MS)){
+    Agree--;                     // calm for a while, ease off
+    Calm = ms;
+  }
+  return next;
+}
+
+// ------------Chatter_Lap------------
+void Chatter_Lap(void){
+  Last = Current;
+  clear(&Current);
+}
+
+// ------------Chatter_Get------------
+const struct Chatter_Stats *Chatter_Get(uint8_t last){
+  return last ? &Last : &Current;
+}
+
+// ------------Chatter_Agree------------
+uint8_t Chatter_Agree(void){
+  return Agree;
+}
@@ -0,0 +1,126 @@
+#ifndef CHATTER_H_
+#define CHATTER_H_
+
+/**
+ * @file      Chatter.h
+ * @brief     FSM chatter detector and N-of-M state filter
+ * @details   A single noisy reading can move the FSM from Center to
+ * Left1 and back on the next step, and every move changes the wheel
+ * duties.  Chatter_Step() sees each state the FSM asks for and decides
+ * which one is committed.<br>
+ * Analyzer: the committed states are kept as runs (a state and how
+ * long it lasted).  When the last 2p runs repeat with period p (2 to
+ * CHATTER_PERIODS), such as Left1 Center Left1 Center, the FSM is in a
+ * cycle; its period and frequency are reported.  Time in each state
+ * and the flip rate are kept per lap.<br>
+ * Filter: with a window M of 1 to CHATTER_WINDOW steps, a change
+ * between steering states is only committed once the new state has
+ * been asked for in N of the last M steps.  With adaptation on, every
+ * cycle found raises N by one, up to M, and each CHATTER_DECAY_MS
+ * without one lowers it back toward the set value.  Changes to or from
+ * the states at CHATTER_STEER and above (Stop and Error) are never
+ * held back.
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup MSP432
+ * @brief
+ * @{*/
+
+/**
+ * \brief FSM states, numbered by their index in fsm[]
+ */
+#define CHATTER_STATES 9
+/**
+ * \brief states below this steer and are filtered
+ */
+#define CHATTER_STEER 7
+/**
+ * \brief largest filter window M
+ */
+#define CHATTER_WINDOW 8
+/**
+ * \brief longest cycle looked for, in runs
+ */
+#define CHATTER_PERIODS 4
+/**
+ * \brief a cycle is chatter only if it repeats within this many ms
+ */
+#define CHATTER_CYCLE_MS 400
+/**
+ * \brief ms without a cycle before the adapted N comes down by one
+ */
+#define CHATTER_DECAY_MS 500
+
+/**
+ * Counts for one lap
+ */
+struct Chatter_Stats {
+  uint32_t Ms;                       // time covered
+  uint32_t Steps;                    // calls to Chatter_Step()
+  uint32_t Asked;                    // steps the FSM asked for another state
+  uint32_t Flips;                    // changes committed
+  uint32_t Cycles;                   // runs that continued a cycle
+  uint8_t Period;                    // runs in the last cycle found, 0 for none
+  uint32_t CycleMs;                  // length of that cycle
+  uint32_t Dwell[CHATTER_STATES];    // ms spent in each state
+  uint32_t Runs[CHATTER_STATES];     // visits to each state
+};
+
+/**
+ * Clear the statistics and the history, and set the filter.
+ * @param  m window, 0 to turn the filter off
+ * @param  n agreement needed, 1 to m
+ * @param  adapt 1 to raise n while the FSM is cycling
+ * @return none
+ * @brief  Initialize the chatter detector
+ */
+void Chatter_Init(uint8_t m, uint8_t n, uint8_t adapt);
+
+/**
+ * Change the filter, for example after a shell command.  Cheap when
+ * nothing changed.
+ * @param  m window, 0 to turn the filter off
+ * @param  n agreement needed, clipped to 1 to m
+ * @param  adapt 1 to raise n while the FSM is cycling
+ * @return none
+ * @brief  Set the filter
+ */
+void Chatter_Set(uint8_t m, uint8_t n, uint8_t adapt);
+
+/**
+ * Take the state the FSM asks for and choose the one to go to.
+ * @param  ms time now
+ * @param  state state the FSM is in, 0 to CHATTER_STATES-1
+ * @param  asked state the FSM's table asks for
+ * @return state to go to, either state or asked
+ * @brief  Filter one FSM step
+ */
+uint8_t Chatter_Step(uint32_t ms, uint8_t state, uint8_t asked);
+
+/**
+ * Keep the statistics of the lap that just ended and start new ones.
+ * @param  none
+ * @return none
+ * @note   Call at the start/finish marker
+ * @brief  Lap boundary
+ */
+void Chatter_Lap(void);
+
+/**
+ * @param  last 1 for the last complete lap, 0 for the one in progress
+ * @return statistics, all zero before the first lap ends
+ * @brief  Chatter statistics
+ */
+const struct Chatter_Stats *Chatter_Get(uint8_t last);
+
+/**
+ * @param  none
+ * @return agreement the filter is using now, raised by adaptation
+ * @brief  Current N
+ */
+uint8_t Chatter_Agree(void);
+
+#endif /* CHATTER_H_ */
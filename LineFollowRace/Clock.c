@@ -58,26 +58,55 @@ uint32_t Postwait = 0;                  // loops between Current Power Mode matc
 uint32_t IFlags = 0;                    // non-zero if transition is invalid
 uint32_t Crystalstable = 0;             // loops before the crystal stabilizes (expect small)
 void Clock_Init48MHz(void){
+  Clock_Start48MHz();
+  Clock_Finish48MHz();
+}
+
+// ------------Clock_Start48MHz------------
+// Start the 48 MHz crystal and request core voltage
+// VCORE1, then return while both settle.  The CPU keeps
+// running at 3 MHz until Clock_Finish48MHz.
+// Input: none
+// Output: none
+void Clock_Start48MHz(void){
   // wait for the PCMCTL0 and Clock System to be write-able by waiting for Power Control Manager to be idle
   while(PCM->CTL1&0x00000100){
-//  while(PCMCTL1&0x00000100){
     Prewait = Prewait + 1;
     if(Prewait >= 100000){
       return;                           // time out error
     }
   }
+  // initialize PJ.3 and PJ.2 and make them HFXT (PJ.3 built-in 48 MHz crystal out; PJ.2 built-in 48 MHz crystal in)
+  PJ->SEL0 |= 0x0C;
+  PJ->SEL1 &= ~0x0C;                    // configure built-in 48 MHz crystal for HFXT operation
+  CS->KEY = 0x695A;                     // unlock CS module for register access
+  CS->CTL2 = (CS->CTL2&~0x00700000) |   // clear HFXTFREQ bit field
+           0x00600000 |                 // configure for 48 MHz external crystal
+           0x00010000 |                 // HFXT oscillator drive selection for crystals >4 MHz
+           0x01000000;                  // enable HFXT; it starts up while the core voltage rises
+  CS->CTL2 &= ~0x02000000;              // disable high-frequency crystal bypass
+  CS->KEY = 0;                          // lock CS module from unintended access
   // request power active mode LDO VCORE1 to support the 48 MHz frequency
   PCM->CTL0 = (PCM->CTL0&~0xFFFF000F) |     // clear PCMKEY bit field and AMR bit field
-//  PCMCTL0 = (PCMCTL0&~0xFFFF000F) |     // clear PCMKEY bit field and AMR bit field
             0x695A0000 |                // write the proper PCM key to unlock write access
             0x00000001;                 // request power active mode LDO VCORE1
   // check if the transition is invalid (see Figure 7-3 on p344 of datasheet)
   if(PCM->IFG&0x00000004){
     IFlags = PCM->IFG;                    // bit 2 set on active mode transition invalid; bits 1-0 are for LPM-related errors; bit 6 is for DC-DC-related error
     PCM->CLRIFG = 0x00000004;             // clear the transition invalid flag
-    // to do: look at CPM bit field in PCMCTL0, figure out what mode you're in, and step through the chart to transition to the mode you want
-    // or be lazy and do nothing; this should work out of reset at least, but it WILL NOT work if Clock_Int32kHz() or Clock_InitLowPower() has been called
-    return;
+    // this should work out of reset at least, but it WILL NOT work if Clock_Int32kHz() or Clock_InitLowPower() has been called
+  }
+}
+
+// ------------Clock_Finish48MHz------------
+// Wait for VCORE1 and the crystal started by
+// Clock_Start48MHz, then switch MCLK to 48 MHz.  Time
+// spent between the two calls comes off these waits.
+// Input: none
+// Output: none
+void Clock_Finish48MHz(void){
+  if(IFlags&0x00000004){
+    return;                             // Clock_Start48MHz failed, stay at 3 MHz
   }
   // wait for the CPM (Current Power Mode) bit field to reflect a change to active mode LDO VCORE1
   while((PCM->CTL0&0x00003F00) != 0x00000100){
@@ -93,22 +122,13 @@ void Clock_Init48MHz(void){
       return;                           // time out error
     }
   }
-  // initialize PJ.3 and PJ.2 and make them HFXT (PJ.3 built-in 48 MHz crystal out; PJ.2 built-in 48 MHz crystal in)
-  PJ->SEL0 |= 0x0C;
-  PJ->SEL1 &= ~0x0C;                    // configure built-in 48 MHz crystal for HFXT operation
-//  PJDIR |= 0x08;                      // make PJ.3 HFXTOUT (unnecessary)
-//  PJDIR &= ~0x04;                     // make PJ.2 HFXTIN (unnecessary)
   CS->KEY = 0x695A;                     // unlock CS module for register access
-  CS->CTL2 = (CS->CTL2&~0x00700000) |   // clear HFXTFREQ bit field
-           0x00600000 |                 // configure for 48 MHz external crystal
-           0x00010000 |                 // HFXT oscillator drive selection for crystals >4 MHz
-           0x01000000;                  // enable HFXT
-  CS->CTL2 &= ~0x02000000;              // disable high-frequency crystal bypass
   // wait for the HFXT clock to stabilize
   while(CS->IFG&0x00000002){
     CS->CLRIFG = 0x00000002;              // clear the HFXT oscillator interrupt flag
     Crystalstable = Crystalstable + 1;
     if(Crystalstable > 100000){
+      CS->KEY = 0;
       return;                           // time out error
     }
   }
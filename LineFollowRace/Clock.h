@@ -63,6 +63,29 @@ policies, either expressed or implied, of the FreeBSD Project.
 void Clock_Init48MHz(void);
 
 
+/**
+ * First half of Clock_Init48MHz(): start the crystal and request
+ * core voltage VCORE1 without waiting for either
+ * @param none
+ * @return none
+ * @note  The CPU stays at 3 MHz until Clock_Finish48MHz(); code in
+ * between must not rely on Clock_Delay1us() timing
+ * @brief  Start the 48 MHz clock
+ */
+void Clock_Start48MHz(void);
+
+
+/**
+ * Second half of Clock_Init48MHz(): wait for VCORE1 and the crystal,
+ * set the flash wait states and switch to 48 MHz
+ * @param none
+ * @return none
+ * @see Clock_Start48MHz()
+ * @brief  Finish switching to 48 MHz
+ */
+void Clock_Finish48MHz(void);
+
+
 /**
  * Return the current bus clock frequency
  * @param none
@@ -36,6 +36,7 @@ those of the authors and should not be interpreted as representing official
 policies, either expressed or implied, of the FreeBSD Project.
  */
 #include <stdint.h>
+#include "msp.h"
 //#include "CortexM.h"
 
 
@@ -83,5 +84,68 @@ void WaitForInterrupt(void){
   __asm  ("    WFI\n"
           "    BX     LR\n");
 }
-	
 
+//*********** CycleCounter_Init ************************
+// enable the DWT cycle counter, counting core clock cycles
+// inputs:  none
+// outputs: none
+void CycleCounter_Init(void){
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // enable trace and debug blocks
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;           // start counting
+}
+
+//*********** CycleCounter_Read ************************
+// read the DWT cycle counter
+// inputs:  none
+// outputs: core clock cycles since CycleCounter_Init
+uint32_t CycleCounter_Read(void){
+  return DWT->CYCCNT;
+}
+
+//*********** Exclusive_Load ************************
+// load a word and mark its address for exclusive access
+// inputs:  R0 is the address
+// outputs: R0 is the word at that address
+void Exclusive_Load(void){
+  __asm  ("    LDREX  R0, [R0]\n"
+          "    BX     LR\n");
+}
+
+//*********** Exclusive_Store ************************
+// store a word only if nothing has broken the exclusive
+// access since Exclusive_Load; any exception does
+// inputs:  R0 is the address, R1 is the word to store
+// outputs: R0 is 0 if stored, 1 if not
+void Exclusive_Store(void){
+  __asm  ("    STREX  R2, R1, [R0]\n"
+          "    MOV    R0, R2\n"
+          "    BX     LR\n");
+}
+
+//*********** Exclusive_Clear ************************
+// give up an exclusive access without storing
+// inputs:  none
+// outputs: none
+void Exclusive_Clear(void){
+  __asm  ("    CLREX\n"
+          "    BX     LR\n");
+}
+
+//*********** MemoryBarrier ************************
+// complete all memory accesses before any that follow
+// inputs:  none
+// outputs: none
+void MemoryBarrier(void){
+  __asm  ("    DMB\n"
+          "    BX     LR\n");
+}
+
+//*********** GetPSP ************************
+// read the process stack pointer, used by the kernel's tasks
+// inputs:  none
+// outputs: PSP
+void GetPSP(void){
+  __asm  ("    MRS    R0, PSP\n"
+          "    BX     LR\n");
+}
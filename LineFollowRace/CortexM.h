@@ -49,6 +49,8 @@ those of the authors and should not be interpreted as representing official
 policies, either expressed or implied, of the FreeBSD Project.
 */
 
+#include <stdint.h>
+
 /*!
  * @defgroup MSP432
  * @brief
@@ -109,5 +111,87 @@ void EndCritical(long sr);    // restore I bit to previous value
  */
 void WaitForInterrupt(void);  
 
+
+/**
+ * Enable the DWT cycle counter.  It counts core clock
+ * cycles and wraps every 2^32 cycles (89 s at 48 MHz).
+ *
+ * @param  none
+ * @return none
+ *
+ * @brief  Starts the core cycle counter
+ */
+void CycleCounter_Init(void);
+
+
+/**
+ * Read the DWT cycle counter.  Differences of two reads
+ * are correct across a wrap when taken as uint32_t.
+ *
+ * @param  none
+ * @return number of core clock cycles since CycleCounter_Init
+ *
+ * @note   Assumes CycleCounter_Init() has been called
+ * @brief  Reads the core cycle counter
+ */
+uint32_t CycleCounter_Read(void);
+
+
+/**
+ * Load a word with LDREX, starting an exclusive access to its address.
+ *
+ * @param  addr is the word to load
+ * @return the word
+ *
+ * @brief  Load-exclusive
+ */
+uint32_t Exclusive_Load(volatile uint32_t *addr);
+
+
+/**
+ * Store a word with STREX.  The store happens only if no exception
+ * or other exclusive access has come between it and Exclusive_Load.
+ *
+ * @param  addr is the word loaded by Exclusive_Load
+ * @param  value is the word to store
+ * @return 0 if stored, 1 if not and the sequence must be retried
+ *
+ * @brief  Store-exclusive
+ */
+uint32_t Exclusive_Store(volatile uint32_t *addr, uint32_t value);
+
+
+/**
+ * Abandon an exclusive access started by Exclusive_Load (CLREX).
+ *
+ * @param  none
+ * @return none
+ *
+ * @brief  Clear the exclusive monitor
+ */
+void Exclusive_Clear(void);
+
+
+/**
+ * Data memory barrier (DMB); memory accesses before it complete
+ * before any after it.
+ *
+ * @param  none
+ * @return none
+ *
+ * @brief  Order memory accesses
+ */
+void MemoryBarrier(void);
+
+/**
+ * Read the process stack pointer, which the kernel's tasks run on.
+ *
+ * @param  none
+ * @return PSP
+ *
+ * @brief  Read PSP
+ */
+uint32_t GetPSP(void);
+
 #endif
 
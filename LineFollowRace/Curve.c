@@ -0,0 +1,106 @@
+// Curve.c
+// Runs on MSP432
+// Least-squares parabola through the last few line positions,
+// for a feed-forward steering term and a speed reduction hint.
+
+#include <stdint.h>
+#include "Reflectance.h"
+#include "Curve.h"
+
+// Weights of the quadratic least-squares fit over x = -7..0,
+// oldest sample first, evaluated at x = 0: the slope is
+// sum(Slope[i]*p[i])/168 per step and the second derivative
+// sum(Second[i]*p[i])/84 per step squared.
+static const int8_t Slope[CURVE_N]  = {35, -3, -27, -37, -33, -15, 17, 63};
+static const int8_t Second[CURVE_N] = { 7,  1,  -3,  -5,  -5,  -3,  1,  7};
+
+static struct Curve_Estimate Est;
+static int32_t Pos[CURVE_N];     // positions, um, newest at Put-1
+static uint32_t Period[CURVE_N]; // us before each one
+static uint8_t Put;
+
+// ------------clear------------
+static void clear(void){
+  Est.Slope = Est.Accel = Est.Bend = 0;
+  Est.Us = 0;
+  Est.Count = 0;
+}
+
+// ------------Curve_Init------------
+void Curve_Init(void){
+  Put = 0;
+  clear();
+}
+
+// ------------Curve_Step------------
+// Input: us period since the last sample
+//        speed robot speed, mm/s
+//        position line position, um
+// Output: none
+void Curve_Step(uint32_t us, uint32_t speed, int32_t position){
+  int32_t s1 = 0, s2 = 0;
+  uint32_t total = 0, d;
+  uint8_t i, k;
+  if(position == REFLECTANCE_NOLINE){
+    clear();                     // no line, no history
+    return;
+  }
+  Pos[Put] = position;
+  Period[Put] = us;
+  Put = (Put + 1)&(CURVE_N-1);
+  if(Est.Count < CURVE_N){
+    Est.Count++;
+    if(Est.Count < CURVE_N){
+      return;
+    }
+  }
+  for(i = 0; i < CURVE_N; i++){  // oldest first
+    k = (Put + i)&(CURVE_N-1);
+    s1 += Slope[i]*Pos[k];
+    s2 += Second[i]*Pos[k];
+    if(i){
+      total += Period[k];        // the oldest sample's period is outside the window
+    }
+  }
+  Est.Us = total/(CURVE_N-1);
+  if(Est.Us == 0){
+    return;
+  }
+  // um per step to um/ms, that is mm/s: 1000/168 = 125/21
+  Est.Slope = s1*125/(21*(int32_t)Est.Us);
+  // um per step^2 to mm/s^2: 1e12/84 um/s^2, then /1000
+  Est.Accel = (int32_t)((int64_t)s2*1000000000/(84*(int64_t)Est.Us*Est.Us));
+  // per um of travel squared to 1/km: times 1e9
+  d = Est.Us*speed/1000;         // um travelled per step
+  if(d < CURVE_MIN_UM){
+    Est.Bend = 0;                // too slow to tell a curve from steering
+  }else{
+    Est.Bend = (int32_t)((int64_t)s2*1000000000/(84*(int64_t)d*d));
+  }
+}
+
+// ------------Curve_Predict------------
+// Input: ms look-ahead time
+// Output: um the line will move, positive to the left
+int32_t Curve_Predict(uint32_t ms){
+  return Est.Slope*(int32_t)ms + (int32_t)((int64_t)Est.Accel*ms*ms/2000);
+}
+
+// ------------Curve_Scale------------
+// Input: gain duty cut per 1/m, in 1/1000
+// Output: speed scale in 1/1000
+uint32_t Curve_Scale(uint32_t gain){
+  uint32_t k = (Est.Bend < 0) ? -Est.Bend : Est.Bend;
+  if(gain == 0){
+    return 1000;
+  }
+  if(k > 1000000){
+    k = 1000000;                 // a 1 mm radius is already a stop
+  }
+  return 1000000/(1000 + gain*k/1000);
+}
+
+// ------------Curve_Get------------
+const struct Curve_Estimate *Curve_Get(void){
+  return &Est;
+}
@@ -0,0 +1,97 @@
+#ifndef CURVE_H_
+#define CURVE_H_
+
+/**
+ * @file      Curve.h
+ * @brief     Look-ahead from the recent history of the line position
+ * @details   The FSM reacts to where the line is under the bar now.  How
+ * it has been moving says where it is going: a line drifting steadily
+ * to one side is a heading error, and one that drifts faster and
+ * faster is a curve the robot is not yet following.<br>
+ * Curve_Step() keeps the last CURVE_N positions (Reflectance_Position())
+ * in a ring and fits a parabola to them by least squares.  With the
+ * samples evenly spaced the fit is two dot products with fixed integer
+ * weights, so there is no matrix to solve; uneven periods from the rate
+ * governor are averaged over the window.  The slope and second
+ * derivative are taken at the newest sample.  From them come the line's
+ * speed and acceleration across the bar, the drift expected over a
+ * look-ahead time (Curve_Predict(), for a feed-forward steering term),
+ * and, with the robot's speed, the curvature of the line relative to
+ * the robot's path (for Curve_Scale(), a speed cut like the planner's).
+ * <br>
+ * A reading without the line empties the history, so a search or the
+ * marker does not leave a false slope behind.  Benchmark.h times one
+ * Curve_Step() as BENCH_CURVE.
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup MSP432
+ * @brief
+ * @{*/
+
+/**
+ * \brief samples fitted, a power of two
+ */
+#define CURVE_N 8
+/**
+ * \brief least travel per step, um, for which a curvature is given
+ */
+#define CURVE_MIN_UM 500
+
+/**
+ * What the fit says about the line, positive to the left; all 0 until
+ * CURVE_N samples with the line have been seen
+ */
+struct Curve_Estimate {
+  int32_t Slope;       // line speed across the bar, mm/s
+  int32_t Accel;       // its rate of change, mm/s^2
+  int32_t Bend;        // curvature of the line relative to the robot's path, 1/km
+  uint32_t Us;         // mean period over the window, us
+  uint32_t Count;      // samples in the history, up to CURVE_N
+};
+
+/**
+ * Empty the history.
+ * @param  none
+ * @return none
+ * @brief  Initialize the estimator
+ */
+void Curve_Init(void);
+
+/**
+ * Add one sample and fit the history again.
+ * @param  us period since the last sample
+ * @param  speed robot speed in mm/s, for the curvature
+ * @param  position line position from Reflectance_Position(), um
+ * @return none
+ * @brief  Update the estimate
+ */
+void Curve_Step(uint32_t us, uint32_t speed, int32_t position);
+
+/**
+ * How far the line will move across the bar, from the slope and
+ * second derivative of the fit.
+ * @param  ms look-ahead time
+ * @return drift in um, positive to the left
+ * @brief  Predicted drift
+ */
+int32_t Curve_Predict(uint32_t ms);
+
+/**
+ * Speed scale for the curvature, of the same form as the planner's.
+ * @param  gain duty cut per 1/m of curvature, in 1/1000; 0 for none
+ * @return scale in 1/1000, 1000 on a straight
+ * @brief  Speed reduction hint
+ */
+uint32_t Curve_Scale(uint32_t gain);
+
+/**
+ * @param  none
+ * @return the last estimate
+ * @brief  Estimate
+ */
+const struct Curve_Estimate *Curve_Get(void);
+
+#endif /* CURVE_H_ */
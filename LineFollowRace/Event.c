@@ -0,0 +1,100 @@
+// Event.c
+// Runs on MSP432
+// Bounded multi-producer, single-consumer event queue.
+// Each slot has a sequence number: Seq == n means slot is
+// free for the n-th put, Seq == n+1 means the n-th event is
+// in it and may be taken.  Producers race only for the Tail
+// index, with LDREX/STREX, and never for a slot.
+
+#include <stdint.h>
+#include "CortexM.h"
+#include "Event.h"
+
+struct Slot {
+  volatile uint32_t Seq;
+  uint32_t Event;
+};
+
+static struct Slot Slots[EVENT_SIZE];
+static volatile uint32_t Tail;   // next put, shared by the producers
+static uint32_t Head;            // next get, consumer only
+static struct Event_Stats Stats;
+
+// ------------increment------------
+// Atomically add one to a counter that ISRs share.
+static void increment(volatile uint32_t *counter){
+  uint32_t n;
+  do{
+    n = Exclusive_Load(counter);
+  }while(Exclusive_Store(counter, n + 1));
+}
+
+// ------------Event_Init------------
+void Event_Init(void){
+  uint32_t i, j;
+  for(i = 0; i < EVENT_SIZE; i++){
+    Slots[i].Seq = i;
+  }
+  Tail = 0;
+  Head = 0;
+  Stats.Put = 0;
+  Stats.Retries = 0;
+  for(j = 0; j < EVENT_TYPES; j++){
+    Stats.Lost[j] = 0;
+  }
+}
+
+// ------------Event_Put------------
+// Claim slot n by moving Tail from n to n+1 exclusively,
+// then fill it and hand it to the consumer by setting
+// its Seq to n+1.
+// Input: event to queue
+// Output: 1 if queued, 0 if full
+uint8_t Event_Put(uint32_t event){
+  struct Slot *slot;
+  uint32_t n;
+  int32_t dif;
+  while(1){
+    n = Exclusive_Load(&Tail);
+    slot = &Slots[n&(EVENT_SIZE-1)];
+    dif = (int32_t)(slot->Seq - n);
+    if(dif == 0){
+      if(Exclusive_Store(&Tail, n + 1) == 0){
+        break;                   // slot n is ours
+      }
+    }else if(dif < 0){
+      Exclusive_Clear();         // the consumer has not freed it yet: full
+      increment(&Stats.Lost[EVENT_TYPE(event)&(EVENT_TYPES-1)]);
+      return 0;
+    }else{
+      Exclusive_Clear();         // another producer took n; reload Tail
+    }
+    increment(&Stats.Retries);
+  }
+  slot->Event = event;
+  MemoryBarrier();               // the event is written before it is published
+  slot->Seq = n + 1;
+  increment(&Stats.Put);
+  return 1;
+}
+
+// ------------Event_Get------------
+// Input: event where to put the oldest event
+// Output: 1 if one was taken, 0 if empty
+uint8_t Event_Get(uint32_t *event){
+  struct Slot *slot = &Slots[Head&(EVENT_SIZE-1)];
+  if(slot->Seq != Head + 1){
+    return 0;                    // empty, or the producer is still filling it
+  }
+  MemoryBarrier();
+  *event = slot->Event;
+  MemoryBarrier();               // read before the slot is handed back
+  slot->Seq = Head + EVENT_SIZE;
+  Head++;
+  return 1;
+}
+
+// ------------Event_GetStats------------
+const struct Event_Stats *Event_GetStats(void){
+  return &Stats;
+}
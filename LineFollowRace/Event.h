@@ -0,0 +1,93 @@
+#ifndef EVENT_H_
+#define EVENT_H_
+
+/**
+ * @file      Event.h
+ * @brief     Lock-free queue carrying events from ISRs to the control task
+ * @details   Any number of producers, at any interrupt priority, call
+ * Event_Put(); the control task is the only consumer and calls
+ * Event_Get().  No interrupts are disabled.  A producer claims a slot
+ * with LDREX/STREX on the tail index and retries only if another
+ * producer or an ISR got in between, then fills the slot and publishes
+ * it through the slot's sequence number.  The slots are preallocated,
+ * so a full queue drops the new event and counts it per type.
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup RSLK_Input_Output
+ * @brief
+ * @{*/
+
+/**
+ * \brief number of slots, a power of 2
+ */
+#define EVENT_SIZE 32
+
+/**
+ * \brief event types, stored in the top 8 bits of an event
+ */
+#define EVENT_BUMP     1    // bump switches changed, data is Bump_Read()
+#define EVENT_SENSOR   2    // a reflectance read finished, data is the result
+#define EVENT_ENCODER  3    // a wheel encoder edge, data is the wheel
+#define EVENT_UART     4    // a character arrived
+#define EVENT_TYPES    8
+
+/**
+ * \brief make an event from a type and 24 bits of data
+ */
+#define EVENT(type, data) (((uint32_t)(type)<<24)|((uint32_t)(data)&0x00FFFFFF))
+/**
+ * \brief type of an event
+ */
+#define EVENT_TYPE(event) ((event)>>24)
+/**
+ * \brief data of an event
+ */
+#define EVENT_DATA(event) ((event)&0x00FFFFFF)
+
+/**
+ * Counters kept by the queue
+ */
+struct Event_Stats {
+  uint32_t Put;                 // events queued
+  uint32_t Retries;             // claims that had to be retried
+  uint32_t Lost[EVENT_TYPES];   // events dropped on a full queue, by type
+};
+
+/**
+ * Empty the queue and clear the counters.
+ * @param  none
+ * @return none
+ * @note   Call before enabling any interrupt that posts events
+ * @brief  Initialize the event queue
+ */
+void Event_Init(void);
+
+/**
+ * Queue an event without blocking or disabling interrupts.
+ * @param  event made with EVENT()
+ * @return 1 if queued, 0 if the queue was full
+ * @note   May be called from any ISR or task
+ * @brief  Post an event
+ */
+uint8_t Event_Put(uint32_t event);
+
+/**
+ * Take the oldest event.
+ * @param  event where to put it
+ * @return 1 if an event was returned, 0 if the queue was empty
+ * @note   Only the control task may call this
+ * @brief  Take an event
+ */
+uint8_t Event_Get(uint32_t *event);
+
+/**
+ * @param  none
+ * @return the queue's counters
+ * @brief  Event queue counters
+ */
+const struct Event_Stats *Event_GetStats(void);
+
+#endif /* EVENT_H_ */
@@ -0,0 +1,129 @@
+// Fixed.c
+// Runs on MSP432
+// Saturating Q15 arithmetic and 8-channel kernels.  The
+// kernels work on two 16-bit lanes per 32-bit register with
+// the Cortex-M4 DSP instructions; the C versions compute the
+// same thing one lane at a time and are the reference.
+// Build with FIXED_PORTABLE defined to use only the C versions.
+
+#include <stdint.h>
+#include <string.h>
+#include "msp.h"
+#include "Fixed.h"
+
+// the CMSIS header for the TI compiler defines these as macros
+#if !defined(FIXED_PORTABLE) && defined(__SMLALD) && defined(__QSUB16) && defined(__SSAT)
+#define SIMD 1
+#else
+#define SIMD 0
+#endif
+
+// ------------clamp------------
+// Saturate a 64-bit sum to 32 bits.
+static int32_t clamp(int64_t x){
+  if(x > INT32_MAX) return INT32_MAX;
+  if(x < INT32_MIN) return INT32_MIN;
+  return (int32_t)x;
+}
+
+// ------------Fixed_Sat------------
+int16_t Fixed_Sat(int32_t x){
+#if SIMD
+  return (int16_t)__SSAT(x, 16);
+#else
+  if(x > FIXED_MAX) return FIXED_MAX;
+  if(x < FIXED_MIN) return FIXED_MIN;
+  return (int16_t)x;
+#endif
+}
+
+// ------------Fixed_Add------------
+int16_t Fixed_Add(int16_t a, int16_t b){
+  return Fixed_Sat((int32_t)a + b);
+}
+
+// ------------Fixed_Sub------------
+int16_t Fixed_Sub(int16_t a, int16_t b){
+  return Fixed_Sat((int32_t)a - b);
+}
+
+// ------------Fixed_Mul------------
+int16_t Fixed_Mul(int16_t a, int16_t b){
+  return Fixed_Sat(((int32_t)a*b)>>15);
+}
+
+// ------------Fixed_Dot8C------------
+// Input: x 8 Q15 inputs
+//        w 8 Q15 weights
+// Output: Q30 sum of products, saturated
+int32_t Fixed_Dot8C(const int16_t x[8], const int16_t w[8]){
+  int64_t sum = 0;
+  int i;
+  for(i = 0; i < 8; i++){
+    sum += (int32_t)x[i]*w[i];
+  }
+  return clamp(sum);
+}
+
+// ------------Fixed_Normalize8C------------
+// Input: x raw values, offset and gain per channel
+// Output: y calibrated values
+void Fixed_Normalize8C(const int16_t x[8], const int16_t offset[8], const int16_t gain[8], int16_t y[8]){
+  int i;
+  int32_t d;
+  for(i = 0; i < 8; i++){
+    d = Fixed_Sub(x[i], offset[i]);
+    y[i] = Fixed_Sat((d*gain[i])>>FIXED_GAIN_SHIFT);
+  }
+}
+
+#if SIMD
+// ------------load2------------
+// Two adjacent 16-bit lanes as one word, lane 0 in the low half.
+static int32_t load2(const int16_t *pt){
+  int32_t v;
+  memcpy(&v, pt, 4);           // a single LDR, unaligned is allowed
+  return v;
+}
+
+// ------------Fixed_Dot8------------
+// SMLALD multiplies both lane pairs and adds the two
+// products to a 64-bit accumulator in one instruction.
+int32_t Fixed_Dot8(const int16_t x[8], const int16_t w[8]){
+  uint64_t sum = 0;
+  sum = __SMLALD(load2(&x[0]), load2(&w[0]), sum);
+  sum = __SMLALD(load2(&x[2]), load2(&w[2]), sum);
+  sum = __SMLALD(load2(&x[4]), load2(&w[4]), sum);
+  sum = __SMLALD(load2(&x[6]), load2(&w[6]), sum);
+  return clamp((int64_t)sum);
+}
+
+// ------------Fixed_Normalize8------------
+// QSUB16 takes off both offsets with saturation, then each
+// lane is scaled (SMULBB/SMULTT) and saturated with SSAT.
+void Fixed_Normalize8(const int16_t x[8], const int16_t offset[8], const int16_t gain[8], int16_t y[8]){
+  int i;
+  int32_t d, g, lo, hi;
+  for(i = 0; i < 8; i += 2){
+    d = __QSUB16(load2(&x[i]), load2(&offset[i]));
+    g = load2(&gain[i]);
+    lo = __SSAT(((int32_t)(int16_t)d*(int16_t)g)>>FIXED_GAIN_SHIFT, 16);
+    hi = __SSAT(((d>>16)*(g>>16))>>FIXED_GAIN_SHIFT, 16);
+    lo = (int32_t)(((uint32_t)lo&0xFFFF)|((uint32_t)hi<<16));
+    memcpy(&y[i], &lo, 4);
+  }
+}
+#else
+int32_t Fixed_Dot8(const int16_t x[8], const int16_t w[8]){
+  return Fixed_Dot8C(x, w);
+}
+
+void Fixed_Normalize8(const int16_t x[8], const int16_t offset[8], const int16_t gain[8], int16_t y[8]){
+  Fixed_Normalize8C(x, offset, gain, y);
+}
+#endif
+
+// ------------Fixed_Simd------------
+uint8_t Fixed_Simd(void){
+  return SIMD;
+}
@@ -0,0 +1,108 @@
+#ifndef FIXED_H_
+#define FIXED_H_
+
+/**
+ * @file      Fixed.h
+ * @brief     Saturating Q15 fixed-point math and 8-channel kernels
+ * @details   Values are signed 16-bit Q15 unless noted: -32768 is -1.0
+ * and 32767 is just under 1.0.  Every operation saturates instead of
+ * wrapping.  The 8-channel kernels, one lane per reflectance sensor,
+ * use the Cortex-M4 DSP instructions (QSUB16, SMLALD, SSAT) when built
+ * with the TI compiler, and a portable C version otherwise.  Both
+ * versions are always compiled in, under different names, and give
+ * identical results for every input; Benchmark_Run() checks this.
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup RSLK_Input_Output
+ * @brief
+ * @{*/
+
+/**
+ * \brief largest Q15 value, just under 1.0
+ */
+#define FIXED_MAX  32767
+/**
+ * \brief smallest Q15 value, -1.0
+ */
+#define FIXED_MIN  -32768
+/**
+ * \brief fraction bits of a Fixed_Normalize8 gain; 256 is a gain of 1.0
+ */
+#define FIXED_GAIN_SHIFT 8
+
+/**
+ * @param  x any 32-bit value
+ * @return x clamped to FIXED_MIN..FIXED_MAX
+ * @brief  Saturate to 16 bits
+ */
+int16_t Fixed_Sat(int32_t x);
+
+/**
+ * @param  a Q15
+ * @param  b Q15
+ * @return a+b, saturated
+ * @brief  Saturating add
+ */
+int16_t Fixed_Add(int16_t a, int16_t b);
+
+/**
+ * @param  a Q15
+ * @param  b Q15
+ * @return a-b, saturated
+ * @brief  Saturating subtract
+ */
+int16_t Fixed_Sub(int16_t a, int16_t b);
+
+/**
+ * Product rounded toward minus infinity; only -1.0*-1.0 saturates.
+ * @param  a Q15
+ * @param  b Q15
+ * @return a*b in Q15, saturated
+ * @brief  Saturating multiply
+ */
+int16_t Fixed_Mul(int16_t a, int16_t b);
+
+/**
+ * Sum of x[i]*w[i] for i = 0 to 7.  The products are accumulated in
+ * 64 bits, so only the final sum saturates.
+ * @param  x 8 Q15 inputs
+ * @param  w 8 Q15 weights
+ * @return dot product in Q30, saturated to 32 bits
+ * @brief  8-channel dot product
+ */
+int32_t Fixed_Dot8(const int16_t x[8], const int16_t w[8]);
+
+/**
+ * y[i] = Sat((Sat(x[i]-offset[i])*gain[i]) >> FIXED_GAIN_SHIFT),
+ * for calibrating each sensor channel to a common scale.
+ * The shift is arithmetic, so negative values round down.
+ * @param  x 8 raw values
+ * @param  offset 8 values subtracted first, such as each channel's reading on white
+ * @param  gain 8 gains, 256 means 1.0
+ * @param  y 8 results, may be the same array as x
+ * @return none
+ * @brief  8-channel offset and gain
+ */
+void Fixed_Normalize8(const int16_t x[8], const int16_t offset[8], const int16_t gain[8], int16_t y[8]);
+
+/**
+ * @brief  Portable C version of Fixed_Dot8(), same results
+ */
+int32_t Fixed_Dot8C(const int16_t x[8], const int16_t w[8]);
+
+/**
+ * @brief  Portable C version of Fixed_Normalize8(), same results
+ */
+void Fixed_Normalize8C(const int16_t x[8], const int16_t offset[8], const int16_t gain[8], int16_t y[8]);
+
+/**
+ * @param  none
+ * @return 1 if Fixed_Dot8() and Fixed_Normalize8() use the DSP instructions, 0 if they are the C versions
+ * @brief  Which kernels were built
+ */
+uint8_t Fixed_Simd(void);
+
+#endif /* FIXED_H_ */
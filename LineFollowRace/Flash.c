@@ -0,0 +1,83 @@
+// Flash.c
+// Runs on MSP432
+// Erase and program the two data sectors at the top of
+// bank 1.  Each sector is write protected again as soon
+// as the operation is done, and every word is read back.
+
+#include <stdint.h>
+#include "msp.h"
+#include "Flash.h"
+
+#define BANK1 0x00020000       // first address of bank 1
+
+// ------------sector------------
+// Check that a range lies inside the data sectors.
+// Input: addr start address
+//        bytes length of the range
+// Output: bank 1 sector number, or 0 if the range is not allowed
+static uint32_t sector(uint32_t addr, uint32_t bytes){
+  if((addr < FLASH_DATA) || (addr + bytes > FLASH_PARAMS + FLASH_SECTOR) || (bytes == 0)){
+    return 0;
+  }
+  return (addr - BANK1)/FLASH_SECTOR;   // 30 or 31
+}
+
+// ------------Flash_Erase------------
+// Erase one data sector.
+// Input: addr start of FLASH_DATA or FLASH_PARAMS
+// Output: 0 on success, 1 on failure
+uint8_t Flash_Erase(uint32_t addr){
+  uint32_t n = sector(addr, FLASH_SECTOR);
+  const volatile uint32_t *pt = (const volatile uint32_t *)addr;
+  uint32_t i;
+  if((n == 0) || (addr & (FLASH_SECTOR-1))){
+    return 1;
+  }
+  FLCTL->BANK1_MAIN_WEPROT &= ~(1<<n);          // unprotect this sector only
+  FLCTL->ERASE_CTLSTAT &= ~(FLCTL_ERASE_CTLSTAT_MODE|FLCTL_ERASE_CTLSTAT_TYPE_MASK); // sector erase of main memory
+  FLCTL->ERASE_SECTADDR = addr;
+  FLCTL->CLRIFG = FLCTL_CLRIFG_ERASE;
+  FLCTL->ERASE_CTLSTAT |= FLCTL_ERASE_CTLSTAT_START;
+  while((FLCTL->IFG & FLCTL_IFG_ERASE) == 0){};
+  FLCTL->ERASE_CTLSTAT |= FLCTL_ERASE_CTLSTAT_CLR_STAT;
+  FLCTL->BANK1_MAIN_WEPROT |= (1<<n);
+  for(i = 0; i < FLASH_SECTOR/4; i++){
+    if(pt[i] != 0xFFFFFFFF){
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// ------------Flash_Write------------
+// Program words one at a time in immediate mode.
+// Input: addr word-aligned destination in a data sector
+//        source words to write
+//        count number of words
+// Output: 0 on success, 1 on failure
+uint8_t Flash_Write(uint32_t addr, const uint32_t *source, uint32_t count){
+  uint32_t n = sector(addr, 4*count);
+  uint32_t last = sector(addr + 4*count - 4, 4);
+  volatile uint32_t *pt = (volatile uint32_t *)addr;
+  uint32_t i;
+  uint8_t result = 0;
+  if((n == 0) || (last == 0) || (addr & 0x03)){
+    return 1;
+  }
+  FLCTL->BANK1_MAIN_WEPROT &= ~((1<<n)|(1<<last));
+  // immediate mode, no pre/post verify
+  FLCTL->PRG_CTLSTAT = (FLCTL->PRG_CTLSTAT&~(FLCTL_PRG_CTLSTAT_MODE|FLCTL_PRG_CTLSTAT_VER_PRE|FLCTL_PRG_CTLSTAT_VER_PST))
+                     | FLCTL_PRG_CTLSTAT_ENABLE;
+  for(i = 0; i < count; i++){
+    FLCTL->CLRIFG = FLCTL_CLRIFG_PRG;
+    pt[i] = source[i];
+    while((FLCTL->IFG & FLCTL_IFG_PRG) == 0){};
+    if(pt[i] != source[i]){
+      result = 1;
+      break;
+    }
+  }
+  FLCTL->PRG_CTLSTAT &= ~FLCTL_PRG_CTLSTAT_ENABLE;
+  FLCTL->BANK1_MAIN_WEPROT |= (1<<n)|(1<<last);
+  return result;
+}
@@ -0,0 +1,58 @@
+#ifndef FLASH_H_
+#define FLASH_H_
+
+/**
+ * @file      Flash.h
+ * @brief     Erase and program the data sectors of main flash
+ * @details   The linker command file keeps the last two 4 kB sectors of
+ * bank 1 out of MAIN, so the program never lands there.  Code runs from
+ * bank 0 while bank 1 is erased or programmed, so the CPU keeps running,
+ * but each call waits for the flash controller to finish.
+<table>
+<caption id="Flash_map">Data sectors</caption>
+<tr><th>Address  <th>Use
+<tr><td>0x0003E000 <td>FLASH_DATA, one record owned by the module that addresses it
+<tr><td>0x0003F000 <td>FLASH_PARAMS, saved tuning parameters
+</table>
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup MSP432
+ * @brief
+ * @{*/
+
+/**
+ * \brief first data sector; the range Flash_Erase and Flash_Write accept starts here
+ */
+#define FLASH_DATA    0x0003E000
+/**
+ * \brief sector holding the saved tuning parameters
+ */
+#define FLASH_PARAMS  0x0003F000
+/**
+ * \brief bytes in one flash sector
+ */
+#define FLASH_SECTOR  0x1000
+
+/**
+ * Erase one 4 kB sector of bank 1 to all ones.
+ * @param  addr start address of the sector, FLASH_DATA or FLASH_PARAMS
+ * @return 0 on success, 1 if addr is not a data sector or the erase failed
+ * @note   Takes one sector erase time; do not call while driving
+ * @brief  Erase a data sector
+ */
+uint8_t Flash_Erase(uint32_t addr);
+
+/**
+ * Program 32-bit words into an erased data sector.
+ * @param  addr destination, word aligned, inside FLASH_DATA or FLASH_PARAMS
+ * @param  source words to write
+ * @param  count number of words
+ * @return 0 on success, 1 if the range is outside the data sectors or a write failed
+ * @brief  Program words into a data sector
+ */
+uint8_t Flash_Write(uint32_t addr, const uint32_t *source, uint32_t count);
+
+#endif /* FLASH_H_ */
@@ -0,0 +1,119 @@
+// Lap.c
+// Runs on MSP432
+// Finds the start/finish marker in the reflectance
+// readings, times laps with Timer32_1 and counts the
+// control steps of each lap by FSM state.
+
+#include <stdint.h>
+#include "msp.h"
+#include "Clock.h"
+#include "Lap.h"
+
+#define MARKER 0xFF              // every sensor black
+
+struct Lap_Stats Lap_Results[LAP_MAX];
+
+static struct Lap_Stats Current; // lap in progress
+static uint32_t Start;           // Timer32_1 value at the last marker
+static uint32_t Laps;            // laps completed
+static uint32_t Hold;            // samples of MARKER that make a marker
+static uint32_t Limit;           // laps to run, 0 for no limit
+static uint32_t Run;             // consecutive samples of MARKER so far
+static uint8_t Racing;           // 1 once the first marker has been seen
+static uint8_t OnMarker;         // 1 until the sensors leave a counted marker
+static uint8_t Last;             // state at the previous sample
+static uint32_t TicksPerMs;      // Timer32_1 counts per ms
+
+// ------------elapsed------------
+// Output: microseconds since the last marker
+static uint32_t elapsed(void){
+  uint32_t ticks = Start - TIMER32_1->VALUE;     // counts down
+  return (ticks/TicksPerMs)*1000 + ((ticks%TicksPerMs)*1000)/TicksPerMs;
+}
+
+// ------------clear------------
+static void clear(struct Lap_Stats *lap){
+  uint8_t i;
+  lap->Us = 0;
+  for(i = 0; i < LAP_STATES; i++){
+    lap->Samples[i] = 0;
+  }
+  lap->Errors = 0;
+}
+
+// ------------Lap_Init------------
+void Lap_Init(uint32_t hold, uint32_t laps){
+  uint8_t i;
+  TIMER32_1->CONTROL = 0;        // stop while changing
+  TIMER32_1->LOAD = 0xFFFFFFFF;
+  // bit7=1, enable; bit6=0, free running; bit5=0, no interrupt; bits3-2=01, prescale /16; bit1=1, 32-bit; bit0=0, wrapping
+  TIMER32_1->CONTROL = 0x86;
+  TicksPerMs = Clock_GetFreq()/16000;            // 3000 at 48 MHz, wraps after 23 minutes
+  for(i = 0; i < LAP_MAX; i++){
+    clear(&Lap_Results[i]);
+  }
+  clear(&Current);
+  Laps = 0;
+  Run = 0;
+  Racing = 0;
+  OnMarker = 0;
+  Last = 0;
+  Lap_Set(hold, laps);
+}
+
+// ------------Lap_Set------------
+void Lap_Set(uint32_t hold, uint32_t laps){
+  Hold = hold ? hold : 1;
+  Limit = laps;
+}
+
+// ------------Lap_Sample------------
+// A marker is counted on the Hold-th MARKER sample in a
+// row, and then ignored until a sample that is not MARKER.
+enum Lap_Event Lap_Sample(uint8_t raw, uint8_t state){
+  if(Limit && (Laps >= Limit)){
+    return LAP_NONE;             // race over
+  }
+  if(Racing){
+    Current.Samples[state]++;
+    if((state == LAP_ERROR) && (Last != LAP_ERROR)){
+      Current.Errors++;
+    }
+  }
+  Last = state;
+  if(raw != MARKER){
+    Run = 0;
+    OnMarker = 0;
+    return LAP_NONE;
+  }
+  Run++;
+  if(OnMarker || (Run < Hold)){
+    return LAP_MARKER;
+  }
+  OnMarker = 1;
+  if(Racing){
+    Current.Us = elapsed();
+    if(Laps < LAP_MAX){
+      Lap_Results[Laps] = Current;
+    }
+    Laps++;
+    if(Limit && (Laps >= Limit)){
+      Racing = 0;                // finished; the caller stops the robot
+      return LAP_DONE;
+    }
+  }
+  Racing = 1;                    // the first marker starts the race
+  Start = TIMER32_1->VALUE;
+  clear(&Current);
+  return LAP_START;
+}
+
+// ------------Lap_Count------------
+uint32_t Lap_Count(void){
+  return Laps;
+}
+
+// ------------Lap_Now------------
+uint32_t Lap_Now(void){
+  return Racing ? elapsed() : 0;
+}
@@ -0,0 +1,105 @@
+#ifndef LAP_H_
+#define LAP_H_
+
+/**
+ * @file      Lap.h
+ * @brief     Start/finish marker detection and per-lap statistics
+ * @details   The start/finish marker is a strip of black across the
+ * whole track, so all eight reflectance sensors read black (0xFF).
+ * Lap_Sample() is given every control step's reading; a marker is
+ * counted when 0xFF is held for a number of consecutive samples, and
+ * the next one can only be counted after the sensors have left it.<br>
+ * The first marker starts the race.  Each one after that ends a lap:
+ * its time, taken from Timer32_1, and the samples spent in each FSM
+ * state are stored in Lap_Results[], which stays in SRAM to be read
+ * with the debugger or the "lap" shell command.  Lap_Sample() reports
+ * when the configured number of laps is done, and the caller stops.
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup MSP432
+ * @brief
+ * @{*/
+
+/**
+ * \brief laps kept in Lap_Results[]; later laps are timed but not stored
+ */
+#define LAP_MAX 16
+/**
+ * \brief FSM states counted, numbered by their index in fsm[]
+ */
+#define LAP_STATES 9
+/**
+ * \brief FSM state number of the Error (line lost) state
+ */
+#define LAP_ERROR 8
+
+/**
+ * One lap
+ */
+struct Lap_Stats {
+  uint32_t Us;                     // lap time, marker to marker
+  uint32_t Samples[LAP_STATES];    // control steps spent in each state
+  uint32_t Errors;                 // times the line was lost (entries into LAP_ERROR)
+};
+
+/**
+ * \brief completed laps, oldest first; Lap_Count() of them are valid
+ */
+extern struct Lap_Stats Lap_Results[LAP_MAX];
+
+/**
+ * What Lap_Sample() saw
+ */
+enum Lap_Event {
+  LAP_NONE,        // ordinary sample
+  LAP_MARKER,      // the sensors are on the marker; do not steer from this reading
+  LAP_START,       // as LAP_MARKER, and the marker was just counted: a lap starts here
+  LAP_DONE         // the last lap just ended
+};
+
+/**
+ * Start Timer32_1 free running and clear the results.
+ * @param  hold samples of 0xFF that make a marker
+ * @param  laps laps to run, 0 for no limit
+ * @return none
+ * @note   Assumes Clock_Init48MHz() has been called
+ * @brief  Initialize lap timing
+ */
+void Lap_Init(uint32_t hold, uint32_t laps);
+
+/**
+ * Change the settings, for example after a shell command.
+ * @param  hold samples of 0xFF that make a marker
+ * @param  laps laps to run, 0 for no limit
+ * @return none
+ * @brief  Set the marker hold and lap count
+ */
+void Lap_Set(uint32_t hold, uint32_t laps);
+
+/**
+ * Take one control step's sensor reading and state.
+ * @param  raw 8-bit reading, 1 is black
+ * @param  state FSM state the robot is in, 0 to LAP_STATES-1
+ * @return LAP_NONE, LAP_MARKER, LAP_START or LAP_DONE
+ * @brief  Count a sample
+ */
+enum Lap_Event Lap_Sample(uint8_t raw, uint8_t state);
+
+/**
+ * @param  none
+ * @return laps completed since the race started
+ * @brief  Completed laps
+ */
+uint32_t Lap_Count(void);
+
+/**
+ * @param  none
+ * @return microseconds into the lap in progress, 0 before the start
+ * @brief  Current lap time
+ */
+uint32_t Lap_Now(void);
+
+#endif /* LAP_H_ */
@@ -7,6 +7,29 @@
 #include "Motor.h"
 #include "SysTick.h"
 #include "Bump.h"
+#include "CortexM.h"
+#include "Recovery.h"
+#include "Benchmark.h"
+#include "UART0.h"
+#include "Param.h"
+#include "Shell.h"
+#include "OS.h"
+#include "Event.h"
+#include "Watchdog.h"
+#include "Stack.h"
+#include "Boot.h"
+#include "Lap.h"
+#include "Tach.h"
+#include "MotorCal.h"
+#include "Odometry.h"
+#include "Log.h"
+#include "Chatter.h"
+#include "SenseTime.h"
+#include "Sample.h"
+#include "Rate.h"
+#include "Curve.h"
+#include "ReflectanceDMA.h"
+#include "Trace.h"
 
 
 /*(Left,Right) Motors, call LaunchPad_Output (positive logic)
@@ -23,8 +46,8 @@
 
 // Linked data structure
 struct State {
-  uint16_t right_PWM;           // Right wheel PWM
-  uint16_t left_PWM;            // Left wheel PWM
+  int16_t right_PWM;            // Right wheel PWM, negative backward
+  int16_t left_PWM;             // Left wheel PWM, negative backward
   const struct State *next[64]; // Next if 6-bit input is 0-63
 };
 
@@ -40,15 +63,16 @@ typedef const struct State State_t;
 #define Stop   &fsm[7]
 #define Error  &fsm[8]
 
-State_t fsm[9]={
+// in RAM so the PWM values can be tuned from the shell
+struct State fsm[9]={
   {3000, 3000,  {Error, Left3, Left2, Left2, Left1, Left1, Left1, Left1, Right1, Error, Error, Error, Center, Center, Center, Center, Right2, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Center, Right3, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Center, Right2, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Error}}, // Center
   {2000, 3000,  {Error, Left3, Left2, Left2, Left1, Left1, Left1, Left1, Right1, Error, Error, Error, Center, Center, Center, Center, Right2, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Center, Right3, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Center, Right2, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Error}}, // Left1
   {1500, 3000,  {Error, Left3, Left2, Left2, Left1, Left1, Left1, Left1, Right1, Error, Error, Error, Center, Center, Center, Center, Right2, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Center, Right3, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Center, Right2, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Error}}, // Left2
-  {   0, 3000,  {Error, Left3, Left2, Left2, Left1, Left1, Left1, Left1, Right1, Error, Error, Error, Center, Center, Center, Center, Right2, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Center, Right3, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Center, Right2, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Error}}, // Left3
+  {-1500, 3000, {Error, Left3, Left2, Left2, Left1, Left1, Left1, Left1, Right1, Error, Error, Error, Center, Center, Center, Center, Right2, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Center, Right3, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Center, Right2, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Error}}, // Left3
 
   {3000, 2000,  {Error, Left3, Left2, Left2, Left1, Left1, Left1, Left1, Right1, Error, Error, Error, Center, Center, Center, Center, Right2, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Center, Right3, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Center, Right2, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Error}}, // Right1
   {3000, 1500,  {Error, Left3, Left2, Left2, Left1, Left1, Left1, Left1, Right1, Error, Error, Error, Center, Center, Center, Center, Right2, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Center, Right3, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Center, Right2, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Error}}, // Right2
-  {3000,    0,  {Error, Left3, Left2, Left2, Left1, Left1, Left1, Left1, Right1, Error, Error, Error, Center, Center, Center, Center, Right2, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Center, Right3, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Center, Right2, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Error}}, // Right3
+  {3000, -1500, {Error, Left3, Left2, Left2, Left1, Left1, Left1, Left1, Right1, Error, Error, Error, Center, Center, Center, Center, Right2, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Center, Right3, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Center, Right2, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Error}}, // Right3
 
   {   0,    0,  {Stop,  Stop,  Stop,  Stop,  Stop,  Stop,  Stop,  Stop,  Stop,   Stop,  Stop,  Stop,  Stop,   Stop,   Stop,   Stop,   Stop,   Stop,  Stop,  Stop,  Stop,  Stop,  Stop,  Stop,  Stop,   Stop,  Stop,  Stop,  Stop,   Stop,   Stop,   Stop,   Stop,   Stop,  Stop,  Stop,  Stop,  Stop,  Stop,  Stop,  Stop,   Stop,  Stop,  Stop,  Stop,   Stop,   Stop,   Stop,   Stop,   Stop,  Stop,  Stop,  Stop,  Stop,  Stop,  Stop,  Stop,   Stop,  Stop,  Stop,  Stop,   Stop,   Stop,   Stop}},   // Stop
   {   0,    0,  {Error, Left3, Left2, Left2, Left1, Left1, Left1, Left1, Right1, Error, Error, Error, Center, Center, Center, Center, Right2, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Center, Right3, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Center, Right2, Error, Error, Error, Error, Error, Error, Error, Right1, Error, Error, Error, Center, Center, Center, Error}}, // Error
@@ -56,6 +80,91 @@ State_t fsm[9]={
 
 State_t *Spt;  // pointer to the current state
 
+uint32_t SensorTime = 1000;    // us, Reflectance_Read wait; with SenseAuto the longest allowed
+uint16_t SenseAuto = 0;        // 1 to tune the wait to the surface (SenseTime.h)
+uint16_t SensePipe = 1;        // 1 to take each reading just before its step (Sample.h), 0 to wait in the step
+#define SENSE_DMA 2            // sense.mode after the two Reflectance.h modes
+#define SENSE_LEVELS 3         // sense.mode, grey levels (Reflectance_ReadLevels)
+uint16_t SenseMode = REFLECTANCE_ALLON;  // emitters: all on, REFLECTANCE_STAGGERED, or SENSE_DMA or SENSE_LEVELS (read in the step)
+uint16_t SenseDark = 10;       // with SENSE_DMA, one ambient capture per this many, 0 for none
+#define SENSE_LEVELS_MAX 4
+uint16_t SenseLevels = 4;      // with SENSE_LEVELS, how many of the delays below are sampled
+uint16_t SenseLevelUs[SENSE_LEVELS_MAX] = {250, 500, 1000, 2000};  // us after the charge, ascending
+uint32_t LoopPeriod = 10000;   // us, start of one control step to the next, whole ms
+uint16_t Telemetry = 0;        // every control step on UART0: 1 as text, 2 as binary Log frames
+uint32_t StepBudget = 3000;    // us, a control step longer than this is an overrun
+uint16_t LapHold = 3;          // all-black samples in a row that make the start/finish marker
+uint16_t LapLimit = 0;         // laps to run before stopping, 0 for no limit
+uint32_t PwmHz = MOTOR_PWM_HZ;  // motor PWM frequency
+uint32_t PlanGain = 0;         // duty cut per 1/m of curvature ahead, in 1/1000; 0 turns the planner off
+uint32_t PlanAhead = 300;      // mm of track the planner looks ahead
+uint16_t MotorLinear = 1;      // 1 to drive through the measured motor table, if there is one
+uint16_t ChatWindow = 0;       // steps a change of steering state is voted on, 0 for no filter
+uint16_t ChatAgree = 2;        // of those, steps that must ask for the new state
+uint16_t ChatAdapt = 1;        // 1 to ask for more agreement while the FSM chatters
+uint16_t RateOn = 0;           // 1 to govern the period by speed (Rate.h), 0 for period.us
+uint32_t RateMin = 4000;       // us, shortest governed period
+uint32_t RateMax = 20000;      // us, longest
+uint32_t RateTravel = 3000;    // um the robot may move per step
+uint32_t RateSlew = 3000;      // um the line may move across the bar per step
+uint32_t CurveGain = 0;        // steering duty per mm of line drift predicted (Curve.h), 0 for none
+uint32_t CurveAhead = 50;      // ms of drift predicted
+uint32_t CurveSlow = 0;        // duty cut per 1/m of curvature seen, in 1/1000; 0 for none
+#ifdef TRACE
+uint32_t TraceMask = 0xF1FFFF; // Trace codes the "trace" command records; encoders and tick left out
+#endif
+
+// Values that can be changed over UART0, applied between control steps
+static const struct Param Params[]={
+  {"center.l", (void *)&fsm[0].left_PWM,  PARAM_S16, -14998, 14998},
+  {"center.r", (void *)&fsm[0].right_PWM, PARAM_S16, -14998, 14998},
+  {"left1.l",  (void *)&fsm[1].left_PWM,  PARAM_S16, -14998, 14998},
+  {"left1.r",  (void *)&fsm[1].right_PWM, PARAM_S16, -14998, 14998},
+  {"left2.l",  (void *)&fsm[2].left_PWM,  PARAM_S16, -14998, 14998},
+  {"left2.r",  (void *)&fsm[2].right_PWM, PARAM_S16, -14998, 14998},
+  {"left3.l",  (void *)&fsm[3].left_PWM,  PARAM_S16, -14998, 14998},
+  {"left3.r",  (void *)&fsm[3].right_PWM, PARAM_S16, -14998, 14998},
+  {"right1.l", (void *)&fsm[4].left_PWM,  PARAM_S16, -14998, 14998},
+  {"right1.r", (void *)&fsm[4].right_PWM, PARAM_S16, -14998, 14998},
+  {"right2.l", (void *)&fsm[5].left_PWM,  PARAM_S16, -14998, 14998},
+  {"right2.r", (void *)&fsm[5].right_PWM, PARAM_S16, -14998, 14998},
+  {"right3.l", (void *)&fsm[6].left_PWM,  PARAM_S16, -14998, 14998},
+  {"right3.r", (void *)&fsm[6].right_PWM, PARAM_S16, -14998, 14998},
+  {"sense.us", (void *)&SensorTime,       PARAM_U32, 100, 3000},
+  {"sense.auto",(void *)&SenseAuto,       PARAM_U16, 0, 1},
+  {"sense.pipe",(void *)&SensePipe,       PARAM_U16, 0, 1},
+  {"sense.mode",(void *)&SenseMode,       PARAM_U16, REFLECTANCE_ALLON, SENSE_LEVELS},
+  {"sense.dark",(void *)&SenseDark,       PARAM_U16, 0, 1000},
+  {"sense.levels",(void *)&SenseLevels,   PARAM_U16, 1, SENSE_LEVELS_MAX},
+  {"sense.l1", (void *)&SenseLevelUs[0],  PARAM_U16, 10, 3000},
+  {"sense.l2", (void *)&SenseLevelUs[1],  PARAM_U16, 10, 3000},
+  {"sense.l3", (void *)&SenseLevelUs[2],  PARAM_U16, 10, 3000},
+  {"sense.l4", (void *)&SenseLevelUs[3],  PARAM_U16, 10, 3000},
+  {"period.us",(void *)&LoopPeriod,       PARAM_U32, 4000, 100000},
+  {"telem",    (void *)&Telemetry,        PARAM_U16, 0, 2},
+  {"budget.us",(void *)&StepBudget,       PARAM_U32, 500, 100000},
+  {"lap.hold", (void *)&LapHold,          PARAM_U16, 1, 50},
+  {"laps",     (void *)&LapLimit,         PARAM_U16, 0, LAP_MAX},
+  {"motor.lin",(void *)&MotorLinear,      PARAM_U16, 0, 1},
+  {"pwm.hz",   (void *)&PwmHz,            PARAM_U32, 50, 20000},
+  {"plan.gain",(void *)&PlanGain,         PARAM_U32, 0, 1000},
+  {"plan.mm",  (void *)&PlanAhead,        PARAM_U32, 0, 2000},
+  {"chat.m",   (void *)&ChatWindow,       PARAM_U16, 0, CHATTER_WINDOW},
+  {"chat.n",   (void *)&ChatAgree,        PARAM_U16, 1, CHATTER_WINDOW},
+  {"chat.adapt",(void *)&ChatAdapt,       PARAM_U16, 0, 1},
+  {"rate.on",  (void *)&RateOn,           PARAM_U16, 0, 1},
+  {"rate.min", (void *)&RateMin,          PARAM_U32, 1000, 100000},
+  {"rate.max", (void *)&RateMax,          PARAM_U32, 1000, 100000},
+  {"rate.um",  (void *)&RateTravel,       PARAM_U32, 500, 50000},
+  {"rate.slew",(void *)&RateSlew,         PARAM_U32, 500, 50000},
+  {"curve.ff", (void *)&CurveGain,        PARAM_U32, 0, 5000},
+  {"curve.ms", (void *)&CurveAhead,       PARAM_U32, 0, 500},
+  {"curve.slow",(void *)&CurveSlow,       PARAM_U32, 0, 1000},
+#ifdef TRACE
+  {"trace.mask",(void *)&TraceMask,       PARAM_U32, 0, (1<<TRACE_IDS)-1},
+#endif
+};
+
 
 /*Run FSM continuously
 1) Output depends on State (LaunchPad LED)
@@ -64,10 +173,69 @@ State_t *Spt;  // pointer to the current state
 4) Next depends on (Input,State)
  */
 
+uint8_t Sensors;   // last 8-bit reading, before the conversion below
+uint8_t Levels[8]; // with SENSE_LEVELS, the grey levels Sensors was taken from
+
+// 1 when readings are latched by Timer_A2 ahead of the step,
+// all-on or the two banks back to back; the DMA pipeline is
+// only read in the step
+uint8_t pipelined(void){
+    return SensePipe && ((SenseMode == REFLECTANCE_ALLON) || (SenseMode == REFLECTANCE_STAGGERED));
+}
+
+// With SENSE_DMA: finish the capture started last step and
+// start the next (ReflectanceDMA_Tick), then call a sensor
+// black if its ambient-corrected decay outlasts SensorTime,
+// as Reflectance_Read would.  The capture is 2 ms long, so a
+// SensorTime of 2000 us or more reads all white.  A dark
+// capture or a step under 2 ms gives no new reading, and the
+// last one is used again.
+uint8_t dmaRead(void){
+    static uint8_t last;
+    uint16_t decay[8];
+    uint8_t i;
+    if(ReflectanceDMA_Tick(decay)){
+        last = 0;
+        for(i = 0; i < 8; i++){
+            if(decay[i] > SensorTime){
+                last |= 1<<i;
+            }
+        }
+    }
+    return last;
+}
+
 // Convert output from reflectance read function to 6 bits
+// Pipelined, the reading was latched by Timer_A2 just before
+// this step; otherwise, or if it is missing or a decay probe
+// is due, the latch is cancelled and the sensors are read
+// here, and the step waits.
 uint8_t read (void) {
-    uint8_t data = Reflectance_Read(1000);
+    uint8_t data;
     uint8_t input = 0x00;
+    uint8_t probe = SenseAuto && SenseTime_Due();   // decided before any latch is taken
+
+    if(SenseMode == SENSE_DMA){
+        data = dmaRead();
+        Sample_Mark();
+    }else if(pipelined() && !probe && Sample_Get(&data)){
+        SenseTime_Count();     // latched before the release, with the tuned wait
+    }else{
+        Sample_Cancel();       // not used this step, or too late; LEDs off
+        while(ReflectanceDMA_Done() == 0){
+        }                      // a capture left from SENSE_DMA owns Timer_A1 until it ends
+        if(SenseMode == SENSE_LEVELS){
+            data = Reflectance_ReadLevels(SenseLevelUs, SenseLevels, Levels);
+        }else if((SenseMode == REFLECTANCE_STAGGERED) && !probe){
+            data = Reflectance_ReadStaggered(SenseAuto ? SenseTime_GetStats()->Us : SensorTime);
+            SenseTime_Count();
+        }else{
+            data = SenseAuto ? SenseTime_Read(SensorTime) : Reflectance_Read(SensorTime);
+        }
+        Sample_Mark();
+    }
+
+    Sensors = data;
 
     input |= (data & 0x01) | ((data & 0x02) >> 1);        // Shift bits 0 and 1 to bit 0
     input |= ((data & 0x04) >> 1);                        // Shift bit 2 to bit 1
@@ -79,21 +247,645 @@ uint8_t read (void) {
     return input;
 }
 
-int main(void){
+// Side the line is on for a state, used by the lost-line search
+// LeftN states steer right, so the line is off the robot's right edge
+uint8_t lineSide(State_t *state){
+    if(state >= Left1 && state <= Left3) return RECOVERY_RIGHT;
+    if(state >= Right1 && state <= Right3) return RECOVERY_LEFT;
+    return RECOVERY_NONE;
+}
 
-  // Initialize everything
-  Clock_Init48MHz();
-  LaunchPad_Init();
-  Reflectance_Init();
-  Motor_Init();
-  SysTick_Init();
+#define STACKSIZE 256          // 32-bit words per task, the lowest 8 are a guard
+// not zeroed by the C startup, which runs at 3 MHz; OS_AddTask paints them
+#pragma DATA_ALIGN(ControlStack, 32)
+#pragma NOINIT(ControlStack)
+static uint32_t ControlStack[STACKSIZE];
+#pragma DATA_ALIGN(ShellStack, 32)
+#pragma NOINIT(ShellStack)
+static uint32_t ShellStack[STACKSIZE];
+#pragma DATA_ALIGN(TelemetryStack, 32)
+#pragma NOINIT(TelemetryStack)
+static uint32_t TelemetryStack[STACKSIZE];
+
+static struct OS_Queue Samples; // control steps for the telemetry task, by Seq
+static uint32_t SampleBuf[16];
+#define STEPS 32               // twice the queue, so a queued step is never overwritten
+static struct Log_Record Steps[STEPS];
+
+// parts of a control step, for the watchdog's overrun report
+// and the trace; the step runs them in the order events,
+// odometry, sense, next, drive, so the motors act on the
+// reading as soon as the FSM has seen it
+enum Stage {STAGE_WAIT, STAGE_EVENTS, STAGE_ODOMETRY, STAGE_DRIVE, STAGE_SENSE, STAGE_NEXT};
+
+uint32_t ControlLatency;       // cycles from the releasing tick to the control task running
+uint32_t ControlLatencyMax;
+
+// Speed planner: slow down ahead of the sharpest curve within
+// PlanAhead, as mapped by odometry on the previous lap.
+// Output: duty scale in 1/1000
+uint32_t plan(void){
+  int32_t k = Odometry_Ahead(PlanAhead*1000);          // 1/km
+  if((PlanGain == 0) || (k <= 0)){
+    return 1000;
+  }
+  return 1000000/(1000 + PlanGain*k/1000);
+}
+
+// Commanded speed in mm/s, from the duties just driven: with a
+// motor table a duty is that fraction of the top speed both
+// wheels reach, without one RATE_TOP_MM_S is assumed
+uint32_t speed(void){
+  const struct Motor_Table *t = Motor_GetTable();
+  int32_t left = Motor_GetDuty(MOTOR_LEFT);
+  int32_t right = Motor_GetDuty(MOTOR_RIGHT);
+  uint32_t top = RATE_TOP_MM_S;
+  if(t && MotorLinear){
+    top = t->Speed[MOTOR_LEFT][MOTOR_POINTS-1];
+    if(t->Speed[MOTOR_RIGHT][MOTOR_POINTS-1] < top){
+      top = t->Speed[MOTOR_RIGHT][MOTOR_POINTS-1];
+    }
+  }
+  if(left < 0) left = -left;
+  if(right < 0) right = -right;
+  return (left + right)*top/(2*14998);
+}
+
+// Feed-forward steering from the line's recent motion: the
+// drift expected over CurveAhead ms, times CurveGain per mm,
+// added to the right wheel and taken from the left, so a
+// line moving left turns the robot left before the FSM sees
+// it reach the next sensor.  Bounded to one full duty.
+// Output: duty difference, positive turns left
+int32_t feedForward(void){
+  int32_t ff;
+  if(CurveGain == 0){
+    return 0;
+  }
+  ff = (int32_t)((int64_t)Curve_Predict(CurveAhead)*(int32_t)CurveGain/1000);   // um to mm
+  if(ff > MOTOR_FULL) ff = MOTOR_FULL;
+  if(ff < -MOTOR_FULL) ff = -MOTOR_FULL;
+  return ff;
+}
+
+// Signed duty for Motor_Drive, limited to full scale
+int16_t duty(int32_t d){
+  if(d > MOTOR_FULL) return MOTOR_FULL;
+  if(d < -MOTOR_FULL) return -MOTOR_FULL;
+  return d;
+}
+
+// DMA decay profile for the "profile" command.  The control
+// task takes it so it never overlaps a sensor read: the shell
+// asks, the capture runs after a step's drive stage, and the
+// next step's sense stage waits for its end and keeps a copy
+// for the shell to print.
+enum Profile {PROFILE_IDLE, PROFILE_WANTED, PROFILE_RUNNING, PROFILE_READY};
+volatile enum Profile Profile;
+uint8_t ProfileBuf[REFLECTANCEDMA_SAMPLES];
+uint16_t ProfileDecay[8];      // us, index 0 is P7.0
+
+// Finish the capture started after the last step
+void keepProfile(void){
+  const uint8_t *buf = ReflectanceDMA_Buffer();
+  uint16_t j;
+  while(ReflectanceDMA_Done() == 0){
+  }                            // still running only if the period is under 2 ms
+  for(j = 0; j < REFLECTANCEDMA_SAMPLES; j++){
+    ProfileBuf[j] = buf[j];
+  }
+  ReflectanceDMA_Decay(ProfileDecay);
+  Profile = PROFILE_READY;
+}
 
+// Drive a pair of wheel duties as one speed and one steering
+// command (Motor_Steer): the faster wheel is the outer one,
+// and the steer that gives the slower one is (outer - inner)
+// /(2 outer) of MOTOR_STEER_FULL, rounded, so the inner duty
+// is within outer/1000 of the one asked for.  An inner wheel
+// backward faster than the outer one is a spin in place.
+// The average duty is never negative, so neither is the outer.
+void steer(int32_t left, int32_t right){
+  int32_t outer, s;
+  left = duty(left);
+  right = duty(right);
+  outer = (right >= left) ? right : left;
+  s = right - left;            // positive turns left
+  if(outer <= 0){
+    Motor_Brake();             // as Motor_Drive(0, 0)
+    return;
+  }
+  s = (s*MOTOR_STEER_FULL + ((s < 0) ? -outer : outer))/(2*outer);
+  if(s > MOTOR_STEER_FULL) s = MOTOR_STEER_FULL;
+  if(s < -MOTOR_STEER_FULL) s = -MOTOR_STEER_FULL;
+  Motor_Steer(outer, s);
+}
+
+// Highest priority: sense, choose the next state and drive,
+// every LoopPeriod, or as often as the rate governor asks
+void controlTask(void){
+  uint32_t last = OS_Time() - LoopPeriod/1000;          // first step runs at once
+  uint32_t period = LoopPeriod;  // us until the next step
+  uint32_t event;
+  uint32_t hz = PwmHz;         // frequency the PWM is running at
+  uint16_t dark = 0;           // ambient refresh ReflectanceDMA is using
+  uint32_t scale;
+  uint16_t seq = 0;
+  struct Log_Record *step;
+  uint32_t release;
+  int32_t position;
+  int32_t ff;
+  uint8_t input;
+  enum Lap_Event lap;
   Spt = Center;
+  Watchdog_Init(StepBudget, LoopPeriod + StepBudget);
+  while(1){
+    ControlLatency = OS_SleepUntil(&last, period/1000);
+    release = CycleCounter_Read() - ControlLatency;     // the tick that released this step
+    Watchdog_Begin();
+    if(ControlLatency > ControlLatencyMax){
+      ControlLatencyMax = ControlLatency;
+    }
+    Param_Commit();                                     // shell changes land between steps
+    Lap_Set(LapHold, LapLimit);
+    Chatter_Set(ChatWindow, ChatAgree, ChatAdapt);
+    Rate_Set(RateMin, RateMax, RateTravel, RateSlew);
+    Motor_Linearize(MotorLinear);
+    if(PwmHz != hz){
+      hz = PwmHz;
+      Motor_SetFrequency(hz);  // 0% until Motor_Drive below
+    }
+    if(SenseDark != dark){
+      dark = SenseDark;
+      ReflectanceDMA_SetAmbientRate(dark);
+    }
+    // the longest sleep the next period can be, set after rate.on is
+    // committed above; a step may be late by up to the budget
+    Watchdog_Set(StepBudget, (RateOn ? RateMax : LoopPeriod) + StepBudget);
+    Watchdog_Stage(STAGE_EVENTS);
+    while(Event_Get(&event)){                           // posted by ISRs since the last step
+      if((EVENT_TYPE(event) == EVENT_BUMP) && EVENT_DATA(event)){
+        Spt = Stop;                                     // hit something, stay stopped
+      }
+    }
+    Watchdog_Stage(STAGE_ODOMETRY);
+    Odometry_Update(Tach_Count(TACH_LEFT), Tach_Count(TACH_RIGHT));
+    scale = plan();
+    Watchdog_Stage(STAGE_SENSE);
+    if(Profile == PROFILE_RUNNING){
+      keepProfile();
+    }
+    input = read();            // read sensors
+    position = (SenseMode == SENSE_LEVELS) ? Reflectance_PositionLevels(Levels) : Reflectance_Position(Sensors);
+    Odometry_Line(position);   // holds the heading on straights from the next step
+    Curve_Step(period, speed(), position);              // speed as driven last step
+    Watchdog_Stage(STAGE_NEXT);
+    lap = Lap_Sample(Sensors, Spt - fsm);
+    if((lap == LAP_START) || (lap == LAP_DONE)){
+      Odometry_Marker();       // back at the origin; closes the lap's heading
+      Chatter_Lap();
+#ifdef TRACE
+      Trace_Marker();          // an armed trace covers exactly one lap
+#endif
+    }
+    if(lap == LAP_DONE){
+      Spt = Stop;              // raced the set number of laps
+    }else if(lap == LAP_NONE){
+      // next depends on input and state; the chatter filter may keep this one
+      Spt = &fsm[Chatter_Step(OS_Time(), Spt - fsm, Spt->next[input] - fsm)];
+    }                          // on the marker: all black says nothing about steering, keep going
+    Watchdog_Stage(STAGE_DRIVE);
+    if(MotorCal_Step(OS_Time())){
+      Spt = Stop;                                       // sweeping; stay parked afterwards
+    }else if(Spt == Error){
+      Recovery_Step();                                  // search toward the side the line was last seen
+    }else if(Spt == Stop){
+      Motor_Brake();                                    // finish or bump: stop short, not coasting on
+    }else{
+      Recovery_LineSeen(lineSide(Spt));                 // ends any search, remembers the side
+      scale = scale*Curve_Scale(CurveSlow)/1000;        // the curve seen, on top of the one mapped
+      ff = feedForward();
+      // Left3 and Right3 run the inner wheel backward, for hairpins
+      steer(Spt->left_PWM*(int32_t)scale/1000 - ff, Spt->right_PWM*(int32_t)scale/1000 + ff);
+      Boot_Mark(BOOT_MOTION);                           // only the first one counts
+    }
+    Sample_Actuated();
+    period = Rate_Step(period, speed(), position);
+    if(RateOn == 0){
+      period = LoopPeriod;     // "rate" still shows what the governor would do
+    }
+    if((Profile == PROFILE_WANTED) && (SenseMode == SENSE_DMA)){
+      Profile = PROFILE_RUNNING;   // keep the capture dmaRead() just started
+    }else if(Profile == PROFILE_WANTED){
+      ReflectanceDMA_Start(1); // owns the sensors until the next step, so no latch this time
+      Profile = PROFILE_RUNNING;
+    }else if(pipelined()){     // a late step wraps the time around and schedules nothing
+      Sample_Schedule(period - (CycleCounter_Read() - release)/48,
+                      SenseAuto ? SenseTime_GetStats()->Us : SensorTime, SenseMode);
+    }
+    Watchdog_End();
+    step = &Steps[seq%STEPS];
+    step->Seq = seq;
+    step->Ms = OS_Time();
+    step->Sensors = Sensors;
+    step->State = Spt - fsm;
+    step->Left = Motor_GetDuty(MOTOR_LEFT);
+    step->Right = Motor_GetDuty(MOTOR_RIGHT);
+    step->LeftCount = Tach_Count(TACH_LEFT);
+    step->RightCount = Tach_Count(TACH_RIGHT);
+    OS_QueuePut(&Samples, seq);   // dropped if telemetry is behind
+    seq++;
+  }
+}
+
+// UART0 command line, polled often enough for typing
+void shellTask(void){
   while(1){
-    Motor_Forward(Spt->left_PWM, Spt->right_PWM);     // do output to two motors
-    SysTick_Wait10ms(1);
-    uint8_t Input = read();    // read sensors
-    Spt = Spt->next[Input];       // next depends on input and state
+    Shell_Poll();
+    OS_Sleep(10);
   }
 }
 
+// LaunchPad LED shows the state, as in the table at the top.
+// With telem 1 each step is printed as "state sensors", with
+// telem 2 it is sent as a Log frame for tools/trackrecon.py
+void telemetryTask(void){
+  static const uint8_t Color[9] = {3, 2, 2, 2, 1, 1, 1, 0, 4};   // Error is blue
+  const struct Log_Record *step;
+  while(1){
+    step = &Steps[OS_QueueGet(&Samples)%STEPS];
+    LaunchPad_Output(Color[step->State]);
+    if(Telemetry == 2){
+      Log_Send(step);
+    }else if(Telemetry && (UART0_TxRoom() >= 16)){
+      UART0_OutSDec(step->State);
+      UART0_OutChar(' ');
+      UART0_OutSDec(step->Sensors);
+      UART0_OutString("\r\n");
+    }
+  }
+}
+
+// "wdt" shell command: how close the control steps run to the budget
+void wdtCommand(void){
+  const struct Watchdog_Stats *s = Watchdog_GetStats();
+  const struct Watchdog_Record *r = Watchdog_GetRecord();
+  UART0_OutString("steps ");     UART0_OutSDec(s->Steps);
+  UART0_OutString(" over ");     UART0_OutSDec(s->Overruns);
+  UART0_OutString(" near ");     UART0_OutSDec(s->NearMisses);
+  UART0_OutString(" max us ");   UART0_OutSDec(s->MaxCycles/48);
+  UART0_OutString(" stage ");    UART0_OutSDec(s->OverrunStage);
+  UART0_OutString("\r\nhangs ");  UART0_OutSDec(r->Expiries);
+  UART0_OutString(" resets ");   UART0_OutSDec(r->Resets);
+  UART0_OutString(" stage ");    UART0_OutSDec(r->Stage);
+  UART0_OutString(" us ");       UART0_OutSDec(r->Cycles/48);
+}
+
+// "stack" shell command: deepest use of each stack so far, in bytes
+void stackCommand(void){
+  UART0_OutString("main ");      UART0_OutSDec(Stack_MainUsed());
+  UART0_OutChar('/');            UART0_OutSDec(Stack_MainSize());
+  UART0_OutString(" control ");  UART0_OutSDec(Stack_Used(ControlStack, STACKSIZE));
+  UART0_OutString(" shell ");    UART0_OutSDec(Stack_Used(ShellStack, STACKSIZE));
+  UART0_OutString(" telem ");    UART0_OutSDec(Stack_Used(TelemetryStack, STACKSIZE));
+  UART0_OutChar('/');            UART0_OutSDec(4*STACKSIZE - STACK_GUARD);
+  UART0_OutString(" faults ");   UART0_OutSDec(Stack_GetFault()->Count);
+}
+
+// "lap" shell command: laps done, the last and best lap, and
+// how the last lap's steps were spread over the states
+void lapCommand(void){
+  uint32_t n = Lap_Count();
+  uint32_t stored = (n < LAP_MAX) ? n : LAP_MAX;
+  uint32_t best = 0;
+  uint32_t i;
+  UART0_OutString("laps ");       UART0_OutSDec(n);
+  UART0_OutString(" now ms ");    UART0_OutSDec(Lap_Now()/1000);
+  if(stored == 0){
+    return;
+  }
+  for(i = 1; i < stored; i++){
+    if(Lap_Results[i].Us < Lap_Results[best].Us){
+      best = i;
+    }
+  }
+  UART0_OutString(" best ");      UART0_OutSDec(best + 1);
+  UART0_OutString(" ms ");        UART0_OutSDec(Lap_Results[best].Us/1000);
+  UART0_OutString("\r\nlast ms "); UART0_OutSDec(Lap_Results[stored-1].Us/1000);
+  UART0_OutString(" errors ");    UART0_OutSDec(Lap_Results[stored-1].Errors);
+  UART0_OutString(" steps");
+  for(i = 0; i < LAP_STATES; i++){
+    UART0_OutChar(' ');
+    UART0_OutSDec(Lap_Results[stored-1].Samples[i]);
+  }
+}
+
+// "sweep" shell command: measure the motors, wheels off the ground
+void sweepCommand(void){
+  MotorCal_Start();
+  UART0_OutString("sweeping");
+}
+
+// "motor" shell command: the linearization table in use,
+// as the dead band (last duty that did not move) and top
+// speed of each wheel
+void motorCommand(void){
+  const struct Motor_Table *t = Motor_GetTable();
+  uint8_t w, k;
+  if(t == 0){
+    UART0_OutString("no table");
+    return;
+  }
+  for(w = 0; w < 2; w++){
+    for(k = 1; (k < MOTOR_POINTS) && (t->Speed[w][k] == 0); k++){
+    }
+    UART0_OutString(w == MOTOR_LEFT ? "left dead " : " right dead ");
+    UART0_OutSDec(t->Duty[k-1]);
+    UART0_OutString(" top mm/s ");
+    UART0_OutSDec(t->Speed[w][MOTOR_POINTS-1]);
+  }
+  UART0_OutString(MotorLinear ? " on" : " off");
+}
+
+// "msave" shell command: keep the table in flash (robot parked)
+void msaveCommand(void){
+  UART0_OutString(Motor_SaveTable() ? "no table or flash error" : "saved");
+}
+
+// "odom" shell command: pose since the start/finish marker
+void odomCommand(void){
+  const struct Odometry_Pose *p = Odometry_Get();
+  UART0_OutString("x mm ");      UART0_OutSDec(p->X/1000);
+  UART0_OutString(" y mm ");     UART0_OutSDec(p->Y/1000);
+  UART0_OutString(" deg ");      UART0_OutSDec((int32_t)(((uint64_t)p->Heading*360)>>32));
+  UART0_OutString(" track mm "); UART0_OutSDec(Odometry_Track()/1000);
+  UART0_OutString(" k/km ");     UART0_OutSDec(Odometry_Curvature());
+  UART0_OutString(" ahead ");    UART0_OutSDec(Odometry_Ahead(PlanAhead*1000));
+  UART0_OutString(" gain ");     UART0_OutSDec(Odometry_Gain());
+  UART0_OutString(" drift deg "); UART0_OutSDec((int32_t)(((int64_t)Odometry_Drift()*360)>>32));
+}
+
+// "chat" shell command: state changes over the last lap (or
+// this one, before a lap is done), those the FSM asked for,
+// the last cycle found, the agreement in use, and the mean
+// ms per visit to each state
+void chatCommand(void){
+  const struct Chatter_Stats *s = Chatter_Get(1);
+  uint8_t i;
+  if(s->Steps == 0){
+    s = Chatter_Get(0);
+  }
+  UART0_OutString("flips ");     UART0_OutSDec(s->Flips);
+  UART0_OutString(" asked ");    UART0_OutSDec(s->Asked);
+  UART0_OutString(" per s ");    UART0_OutSDec(s->Ms ? s->Flips*1000/s->Ms : 0);
+  UART0_OutString(" cycles ");   UART0_OutSDec(s->Cycles);
+  UART0_OutString(" period ");   UART0_OutSDec(s->Period);
+  UART0_OutString(" mHz ");      UART0_OutSDec(s->CycleMs ? 1000000/s->CycleMs : 0);
+  UART0_OutString(" n ");        UART0_OutSDec(Chatter_Agree());
+  UART0_OutString("\r\ndwell ms");
+  for(i = 0; i < CHATTER_STATES; i++){
+    UART0_OutChar(' ');
+    UART0_OutSDec(s->Runs[i] ? s->Dwell[i]/s->Runs[i] : 0);
+  }
+}
+
+// One line of Reflectance_GetStats() per emitter mode, the
+// one in use marked with a *
+void senseMode(char *name, uint8_t mode, uint8_t used){
+  const struct Reflectance_Stats *r = Reflectance_GetStats();
+  UART0_OutString(name);
+  UART0_OutString(used ? "* reads " : "reads ");
+  UART0_OutSDec(r->Reads[mode]);
+  UART0_OutString(" misreads "); UART0_OutSDec(r->Misreads[mode]);
+  UART0_OutString(" emitter_us "); UART0_OutSDec(r->EmitterUs[mode]);
+}
+
+// "sense" shell command: the sensor wait in use, what it was
+// chosen from, and the read rate it allows, then the reads
+// taken with each emitter mode (sense.mode), the time a
+// grey-level read takes, and for the DMA pipeline the
+// captures spent lit and dark and the CPU time each last
+// took to process
+void senseCommand(void){
+  const struct SenseTime_Stats *s = SenseTime_GetStats();
+  const struct ReflectanceDMA_Cost *c = ReflectanceDMA_GetCost();
+  UART0_OutString("us ");        UART0_OutSDec(SenseAuto ? s->Us : SensorTime);
+  UART0_OutString(SenseAuto ? " auto" : " fixed");
+  UART0_OutString(" white ");    UART0_OutSDec(s->White);
+  UART0_OutString(" black ");    UART0_OutSDec(s->Black);
+  UART0_OutString(" probes ");   UART0_OutSDec(s->Probes);
+  UART0_OutString(" split ");    UART0_OutSDec(s->Splits);
+  UART0_OutString(" hz ");       UART0_OutSDec(1000000/((SenseAuto ? s->Us : SensorTime) + 10));
+  senseMode("\r\nallon ", REFLECTANCE_ALLON, SenseMode == REFLECTANCE_ALLON);
+  senseMode("\r\nstaggered ", REFLECTANCE_STAGGERED, SenseMode == REFLECTANCE_STAGGERED);
+  senseMode("\r\nlevels ", REFLECTANCE_LEVELS, SenseMode == SENSE_LEVELS);
+  UART0_OutString(" read_us ");  UART0_OutSDec(SenseLevelUs[SenseLevels-1] + 10);
+  UART0_OutString((SenseMode == SENSE_DMA) ? "\r\ndma* lit " : "\r\ndma lit ");
+  UART0_OutSDec(c->Lit);
+  UART0_OutString(" dark ");     UART0_OutSDec(c->Dark);
+  UART0_OutString(" lit_us ");   UART0_OutSDec(c->LitCycles/48);
+  UART0_OutString(" dark_us ");  UART0_OutSDec(c->DarkCycles/48);
+}
+
+// "sample" shell command: how old readings were when the
+// motors acted on them, in us, with a count per doubling of
+// age from under 32 us up; clears the counts for the next look
+void sampleCommand(void){
+  const struct Sample_Stats *s = Sample_GetStats();
+  uint8_t k;
+  UART0_OutString(pipelined() ? "pipelined" : "blocking");
+  UART0_OutString(" timed ");    UART0_OutSDec(s->Timed);
+  UART0_OutString(" in step ");  UART0_OutSDec(s->Blocking);
+  if(s->Steps){
+    UART0_OutString(" age min ");  UART0_OutSDec(s->MinUs);
+    UART0_OutString(" mean ");     UART0_OutSDec(s->TotalUs/s->Steps);
+    UART0_OutString(" max ");      UART0_OutSDec(s->MaxUs);
+    UART0_OutString("\r\nbins");
+    for(k = 0; k < SAMPLE_BINS; k++){
+      UART0_OutChar(' ');
+      UART0_OutSDec(s->Bins[k]);
+    }
+  }
+  Sample_Clear();
+}
+
+// "rate" shell command: the control period in use and what
+// the governor chose it from, and the range and mean of the
+// periods it has chosen
+void rateCommand(void){
+  const struct Rate_Stats *s = Rate_GetStats();
+  UART0_OutString("us ");        UART0_OutSDec(RateOn ? s->Us : LoopPeriod);
+  UART0_OutString(RateOn ? " governed" : " fixed");
+  UART0_OutString(" mm/s ");     UART0_OutSDec(s->Speed);
+  UART0_OutString(" slew ");     UART0_OutSDec(s->Slew);
+  if(s->Steps){
+    UART0_OutString(" min ");    UART0_OutSDec(s->MinUs);
+    UART0_OutString(" mean ");   UART0_OutSDec(s->TotalUs/s->Steps);
+    UART0_OutString(" max ");    UART0_OutSDec(s->MaxUs);
+  }
+}
+
+// "curve" shell command: the line's motion across the bar
+// fitted over the last CURVE_N steps, the drift predicted,
+// and what the controller does with them
+void curveCommand(void){
+  const struct Curve_Estimate *e = Curve_Get();
+  UART0_OutString("n ");         UART0_OutSDec(e->Count);
+  UART0_OutString(" mm/s ");     UART0_OutSDec(e->Slope);
+  UART0_OutString(" mm/s2 ");    UART0_OutSDec(e->Accel);
+  UART0_OutString(" k/km ");     UART0_OutSDec(e->Bend);
+  UART0_OutString(" ahead um "); UART0_OutSDec(Curve_Predict(CurveAhead));
+  UART0_OutString(" ff ");       UART0_OutSDec(feedForward());
+  UART0_OutString(" scale ");    UART0_OutSDec(Curve_Scale(CurveSlow));
+}
+
+// "profile" shell command: one DMA capture of the decay
+// profile, lit, taken between control steps; with SENSE_DMA
+// it is the pipeline's own capture, which may be a dark one.  Prints the
+// decay time of each sensor, P7.0 first, then the profile as
+// the time in us at which each new P7 byte appeared.
+void profileCommand(void){
+  uint16_t j;
+  uint8_t i;
+  if((Profile == PROFILE_IDLE) || (Profile == PROFILE_READY)){
+    Profile = PROFILE_WANTED;
+  }
+  for(i = 0; (i < 50) && (Profile != PROFILE_READY); i++){
+    OS_Sleep(10);              // the next step or two, at most 100 ms apart
+  }
+  if(Profile != PROFILE_READY){
+    UART0_OutString("busy");   // still wanted; the next "profile" picks it up
+    return;
+  }
+  UART0_OutString("us");
+  for(i = 0; i < 8; i++){
+    UART0_OutChar(' ');
+    UART0_OutSDec(ProfileDecay[i]);
+  }
+  UART0_OutString("\r\n");
+  for(j = 0; j < REFLECTANCEDMA_SAMPLES; j++){
+    if((j == 0) || (ProfileBuf[j] != ProfileBuf[j-1])){
+      while(UART0_TxRoom() < 16){
+        OS_Sleep(1);
+      }
+      UART0_OutSDec(j*REFLECTANCEDMA_PERIOD_US);
+      UART0_OutChar(':');
+      UART0_OutSDec(ProfileBuf[j]);
+      UART0_OutChar(' ');
+    }
+  }
+  Profile = PROFILE_IDLE;
+}
+
+// "recovery" shell command: lost-line searches so far, how
+// many ran on into the spiral, and how many control steps
+// each took to find the line again
+void recoveryCommand(void){
+  const struct Recovery_Stats *s = Recovery_GetStats();
+  UART0_OutString("searches ");  UART0_OutSDec(s->Searches);
+  UART0_OutString(" spirals ");  UART0_OutSDec(s->Spirals);
+  if(s->Min <= s->Max){        // one search has ended
+    UART0_OutString(" last ");   UART0_OutSDec(s->Last);
+    UART0_OutString(" min ");    UART0_OutSDec(s->Min);
+    UART0_OutString(" mean ");   UART0_OutSDec(s->Total/s->Searches);
+    UART0_OutString(" max ");    UART0_OutSDec(s->Max);
+  }
+}
+
+// "boot" shell command: when each part of startup ended, in us after main()
+void bootCommand(void){
+  static const char *Name[BOOT_PHASES] = {"main ", " clkstart ", " gpio ", " clock ", " drivers ", " launch ", " motion "};
+  uint8_t i;
+  for(i = 0; i < BOOT_PHASES; i++){
+    UART0_OutString(Name[i]);
+    UART0_OutSDec(Boot_Us((enum Boot_Phase)i));
+  }
+}
+
+#ifdef TRACE
+// "trace" shell command: how the last trace went, then arm
+// a new one for the next lap.  Read Trace with the debugger
+// and convert it with tools/trace2chrome.py.
+void traceCommand(void){
+  static const char *Name[4] = {"idle", "armed", "recording", "done"};
+  UART0_OutString(Name[Trace_State()]);
+  if(Trace.Magic == TRACE_MAGIC){
+    UART0_OutString(" words ");  UART0_OutSDec(Trace.Count);
+    UART0_OutChar('/');          UART0_OutSDec(TRACE_SIZE);
+    UART0_OutString(" lost ");   UART0_OutSDec(Trace.Lost);
+  }
+  if(Trace_State() != 2){
+    Trace_Arm(TraceMask);
+    UART0_OutString(TraceMask ? ", armed for the next lap" : "");
+  }
+}
+#endif
+
+int main(void){
+
+  // Initialize everything.  The pins are set up while the
+  // crystal and core voltage settle, which used to be idle time.
+  CycleCounter_Init();
+  Boot_Mark(BOOT_MAIN);
+  Watchdog_Boot();   // a hang until the control task starts resets
+  Clock_Start48MHz();
+  Boot_Mark(BOOT_CLOCK_START);
+  Motor_Init();      // motor drivers asleep as early as possible
+  LaunchPad_Init();
+  Bump_Init();
+  Reflectance_Init();
+  ReflectanceDMA_Init();
+  Boot_Mark(BOOT_GPIO);
+  Clock_Finish48MHz();
+  Boot_Mark(BOOT_CLOCK);
+  Stack_Init();      // paint and guard the main stack, 16 times faster at 48 MHz
+  SysTick_Init();
+  Recovery_Init();
+  UART0_Init();
+  Tach_Init();
+  Odometry_Init(Tach_Count(TACH_LEFT), Tach_Count(TACH_RIGHT));
+  Motor_LoadTable();
+  Event_Init();
+  BumpInt_Init();
+  Param_Init(Params, sizeof(Params)/sizeof(Params[0]));   // restores saved values
+  Motor_SetFrequency(PwmHz);
+  Lap_Init(LapHold, LapLimit);
+  Chatter_Init(ChatWindow, ChatAgree, ChatAdapt);
+  SenseTime_Init(SensorTime);
+  Sample_Init();
+  Rate_Init(LoopPeriod);
+  Curve_Init();
+  Shell_Init();
+  Shell_AddCommand("wdt", wdtCommand);
+  Shell_AddCommand("stack", stackCommand);
+  Shell_AddCommand("boot", bootCommand);
+  Shell_AddCommand("lap", lapCommand);
+  Shell_AddCommand("sweep", sweepCommand);
+  Shell_AddCommand("motor", motorCommand);
+  Shell_AddCommand("msave", msaveCommand);
+  Shell_AddCommand("odom", odomCommand);
+  Shell_AddCommand("chat", chatCommand);
+  Shell_AddCommand("sense", senseCommand);
+  Shell_AddCommand("sample", sampleCommand);
+  Shell_AddCommand("rate", rateCommand);
+  Shell_AddCommand("curve", curveCommand);
+  Shell_AddCommand("profile", profileCommand);
+  Shell_AddCommand("recovery", recoveryCommand);
+#ifdef TRACE
+  Shell_AddCommand("trace", traceCommand);
+#endif
+  EnableInterrupts();
+  Boot_Mark(BOOT_DRIVERS);
+#ifdef BENCHMARK
+  Benchmark_Run();   // results in Benchmark_Results[], read with the debugger
+#endif
+
+  // shell and telemetry share a priority so their UART0 output never interleaves
+  OS_Init();
+  OS_QueueInit(&Samples, SampleBuf, 16);
+  OS_AddTask(controlTask, 0, ControlStack, STACKSIZE);
+  OS_AddTask(shellTask, 1, ShellStack, STACKSIZE);
+  OS_AddTask(telemetryTask, 1, TelemetryStack, STACKSIZE);
+  Boot_Mark(BOOT_LAUNCH);
+  OS_Launch();       // does not return
+}
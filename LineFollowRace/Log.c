@@ -0,0 +1,55 @@
+// Log.c
+// Runs on MSP432
+// Packs control step records into checksummed binary
+// frames on UART0.
+
+#include <stdint.h>
+#include "UART0.h"
+#include "Log.h"
+
+static uint32_t Dropped;
+
+// ------------put------------
+// Append n little-endian bytes of value to a frame.
+static uint8_t *put(uint8_t *pt, uint32_t value, uint8_t n){
+  while(n){
+    *pt++ = (uint8_t)value;
+    value >>= 8;
+    n--;
+  }
+  return pt;
+}
+
+// ------------Log_Send------------
+uint8_t Log_Send(const struct Log_Record *r){
+  uint8_t frame[LOG_FRAME];
+  uint8_t *pt = frame;
+  uint8_t sum = 0;
+  uint8_t i;
+  if(UART0_TxRoom() < LOG_FRAME){
+    Dropped++;
+    return 0;
+  }
+  pt = put(pt, 0x5AA5, 2);
+  pt = put(pt, r->Seq, 2);
+  pt = put(pt, r->Ms, 4);
+  pt = put(pt, r->Sensors, 1);
+  pt = put(pt, r->State, 1);
+  pt = put(pt, (uint16_t)r->Left, 2);
+  pt = put(pt, (uint16_t)r->Right, 2);
+  pt = put(pt, (uint32_t)r->LeftCount, 4);
+  pt = put(pt, (uint32_t)r->RightCount, 4);
+  for(i = 2; i < LOG_FRAME-1; i++){
+    sum += frame[i];
+  }
+  *pt = sum;
+  for(i = 0; i < LOG_FRAME; i++){
+    UART0_OutChar(frame[i]);
+  }
+  return 1;
+}
+
+// ------------Log_Dropped------------
+uint32_t Log_Dropped(void){
+  return Dropped;
+}
@@ -0,0 +1,68 @@
+#ifndef LOG_H_
+#define LOG_H_
+
+/**
+ * @file      Log.h
+ * @brief     Binary log of every control step over UART0
+ * @details   Each control step becomes one LOG_FRAME-byte frame, sent
+ * whole or not at all so the stream always parses; frames that do not
+ * fit in the transmit FIFO are counted and skipped, which shows up as
+ * a gap in Seq.  tools/trackrecon.py reads captured logs.
+<table>
+<caption id="log_frame">Frame, little-endian</caption>
+<tr><th>Byte<th>Field
+<tr><td>0-1<td>0xA5 0x5A sync
+<tr><td>2-3<td>Seq, step number
+<tr><td>4-7<td>Ms, kernel time
+<tr><td>8<td>Sensors, 8-bit reflectance reading, 1 is black
+<tr><td>9<td>State, index in fsm[]
+<tr><td>10-11<td>Left duty, Motor_GetDuty(), negative backward
+<tr><td>12-13<td>Right duty
+<tr><td>14-17<td>Left encoder count, Tach_Count()
+<tr><td>18-21<td>Right encoder count
+<tr><td>22<td>sum of bytes 2 to 21, modulo 256
+</table>
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup RSLK_Input_Output
+ * @brief
+ * @{*/
+
+/**
+ * \brief bytes in one frame
+ */
+#define LOG_FRAME 23
+
+/**
+ * One control step
+ */
+struct Log_Record {
+  uint16_t Seq;
+  uint32_t Ms;
+  uint8_t Sensors;
+  uint8_t State;
+  int16_t Left;
+  int16_t Right;
+  int32_t LeftCount;
+  int32_t RightCount;
+};
+
+/**
+ * Send one record as a frame, if it fits.
+ * @param  r record to send
+ * @return 1 if queued, 0 if the transmit FIFO had no room
+ * @brief  Log a control step
+ */
+uint8_t Log_Send(const struct Log_Record *r);
+
+/**
+ * @param  none
+ * @return frames skipped for lack of room
+ * @brief  Dropped frames
+ */
+uint32_t Log_Dropped(void);
+
+#endif /* LOG_H_ */
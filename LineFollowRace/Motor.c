@@ -51,11 +51,66 @@ policies, either expressed or implied, of the FreeBSD Project.
 #include "CortexM.h" // is this needed?
 #include "Motor.h"
 #include "PWM.h"
+#include "Flash.h"
+
+
+static struct Motor_Table Table;
+static uint8_t Valid;          // 1 when Table holds a measured table
+static uint8_t Linear = 1;     // 1 to apply it
+static uint16_t Top;           // mm/s both wheels reach at full duty
+static int16_t Duty[2];        // last duties commanded, negative backward
+
+// ------------checksum------------
+// Sum of every word of a table before Check.
+static uint32_t checksum(const struct Motor_Table *t){
+  const uint32_t *pt = (const uint32_t *)t;
+  uint32_t sum = 0;
+  uint32_t i;
+  for(i = 0; i < (sizeof(struct Motor_Table)/4 - 1); i++){
+    sum += pt[i];
+  }
+  return sum;
+}
 
-#define PWM_PERIOD_100_HZ 14998
+// ------------linear------------
+// Find the duty that gives duty/MOTOR_FULL of Top
+// by interpolating between measured points.  Below the
+// first point that moved, the interpolation starts from
+// the last duty that did not, the edge of the dead band.
+// Input: wheel MOTOR_LEFT or MOTOR_RIGHT
+//        duty 0 to 14,998, proportional to the speed wanted
+// Output: duty to send to that wheel
+static uint16_t linear(uint8_t wheel, uint16_t duty){
+  const uint16_t *speed = Table.Speed[wheel];
+  uint32_t target, result;
+  uint8_t k;
+  if((Valid == 0) || (Linear == 0) || (duty == 0)){
+    return duty;
+  }
+  if(duty > MOTOR_FULL){
+    duty = MOTOR_FULL;
+  }
+  target = (uint32_t)duty*Top/MOTOR_FULL;
+  for(k = 1; (k < MOTOR_POINTS-1) && (speed[k] < target); k++){
+  }
+  if(speed[k] <= speed[k-1]){
+    return Table.Duty[k];
+  }
+  result = Table.Duty[k-1] + (target - speed[k-1])*(Table.Duty[k] - Table.Duty[k-1])/(speed[k] - speed[k-1]);
+  return (result > MOTOR_FULL) ? MOTOR_FULL : result;
+}
 
 // *******Lab 13 solution*******
 
+// ------------output------------
+// Linearize, then scale from MOTOR_FULL to PWM_FULL.
+// P2.6 (PWM3) is the right motor, P2.7 (PWM4) the left.
+static void output(uint16_t leftDuty, uint16_t rightDuty){
+  uint32_t right = linear(MOTOR_RIGHT, rightDuty);
+  uint32_t left = linear(MOTOR_LEFT, leftDuty);
+  PWM_Set34((right*PWM_FULL + MOTOR_FULL/2)/MOTOR_FULL, (left*PWM_FULL + MOTOR_FULL/2)/MOTOR_FULL);
+}
+
 // ------------Motor_Init------------
 // Initialize GPIO pins for output, which will be
 // used to control the direction of the motors and
@@ -90,8 +145,9 @@ void Motor_Init(void){
 void Motor_Stop(void){
   // write this as part of Lab 13
 
-    // turn off the PWM generation
-    PWM_Init34(PWM_PERIOD_100_HZ, 0, 0); // period doesnt matter
+    // 0% duty, the timer keeps running
+    PWM_Set34(0, 0);
+    Duty[MOTOR_LEFT] = Duty[MOTOR_RIGHT] = 0;
 
     // put the drivers to sleep.
     P3->OUT &= ~0xC0;   // low current sleep mode
@@ -113,7 +169,9 @@ void Motor_Forward(uint16_t leftDuty, uint16_t rightDuty){
     P3->OUT |= 0xC0; // take motors out of sleep
     P5->OUT &= ~0x30; // set phase to 0 to go forward
 
-    PWM_Init34(PWM_PERIOD_100_HZ, rightDuty, leftDuty);
+    Duty[MOTOR_LEFT] = leftDuty;
+    Duty[MOTOR_RIGHT] = rightDuty;
+    output(leftDuty, rightDuty);
 
 }
 
@@ -131,10 +189,12 @@ void Motor_Right(uint16_t leftDuty, uint16_t rightDuty){
     // set the motor direction
     P3->OUT |= 0xC0; // take motors out of sleep
 
-    P5->OUT &= ~0x20; // set left motor phase to forward (0)
-    P5->OUT |= 0x10; // set right motor phase to backward (1)
+    P5->OUT &= ~0x10; // set left motor phase to forward (0)
+    P5->OUT |= 0x20; // set right motor phase to backward (1)
 
-    PWM_Init34(PWM_PERIOD_100_HZ, rightDuty, leftDuty);
+    Duty[MOTOR_LEFT] = leftDuty;
+    Duty[MOTOR_RIGHT] = -rightDuty;
+    output(leftDuty, rightDuty);
 
 
 }
@@ -153,10 +213,12 @@ void Motor_Left(uint16_t leftDuty, uint16_t rightDuty){
     // set the motor direction
     P3->OUT |= 0xC0; // take motors out of sleep
 
-    P5->OUT |= 0x20; // set left motor phase to forward (0)
-    P5->OUT &= ~0x10; // set right motor phase to backward (1)
+    P5->OUT |= 0x10; // set left motor phase to backward (1)
+    P5->OUT &= ~0x20; // set right motor phase to forward (0)
 
-    PWM_Init34(PWM_PERIOD_100_HZ, rightDuty, leftDuty);
+    Duty[MOTOR_LEFT] = -leftDuty;
+    Duty[MOTOR_RIGHT] = rightDuty;
+    output(leftDuty, rightDuty);
 
 }
 
@@ -175,6 +237,151 @@ void Motor_Backward(uint16_t leftDuty, uint16_t rightDuty){
     P3->OUT |= 0xC0; // take motors out of sleep
     P5->OUT |= 0x30; // set phase to 1 to go backward
 
-    PWM_Init34(PWM_PERIOD_100_HZ, rightDuty, leftDuty);
+    Duty[MOTOR_LEFT] = -leftDuty;
+    Duty[MOTOR_RIGHT] = -rightDuty;
+    output(leftDuty, rightDuty);
+
+}
+
+// ------------Motor_Drive------------
+// Run each wheel forward or backward on its own, so
+// the robot can pivot with the wheels turning against
+// each other at any pair of duties.  A wheel at 0 is
+// braked: the driver shorts it for the whole period.
+// Input: leftDuty  duty cycle of left wheel (-14,998 to 14,998), negative backward
+//        rightDuty duty cycle of right wheel (-14,998 to 14,998), negative backward
+// Output: none
+// Assumes: Motor_Init() has been called
+void Motor_Drive(int16_t leftDuty, int16_t rightDuty){
+  uint16_t left = (leftDuty < 0) ? -(int32_t)leftDuty : leftDuty;
+  uint16_t right = (rightDuty < 0) ? -(int32_t)rightDuty : rightDuty;
+  uint8_t phase = 0;
+  if(left > MOTOR_FULL) left = MOTOR_FULL;
+  if(right > MOTOR_FULL) right = MOTOR_FULL;
+  if(leftDuty < 0) phase |= 0x10;    // left motor phase backward (1)
+  if(rightDuty < 0) phase |= 0x20;   // right motor phase backward (1)
+
+  P3->OUT |= 0xC0; // take motors out of sleep
+  P5->OUT = (P5->OUT&~0x30)|phase;
+
+  Duty[MOTOR_LEFT] = (leftDuty < 0) ? -left : left;
+  Duty[MOTOR_RIGHT] = (rightDuty < 0) ? -right : right;
+  output(left, right);
+}
+
+// ------------Motor_Steer------------
+// Drive at a speed along a curve.  The outer wheel
+// runs at duty; the inner one slows as |steer| grows,
+// stops at MOTOR_STEER_FULL/2 and runs backward beyond
+// that, up to a spin in place at MOTOR_STEER_FULL.
+// Input: duty      duty cycle of the outer wheel (0 to 14,998)
+//        steer     -MOTOR_STEER_FULL (right) to MOTOR_STEER_FULL (left), 0 straight
+// Output: none
+// Assumes: Motor_Init() has been called
+void Motor_Steer(uint16_t duty, int16_t steer){
+  int32_t s = (steer < 0) ? -steer : steer;
+  int32_t inner;
+  if(s > MOTOR_STEER_FULL) s = MOTOR_STEER_FULL;
+  if(duty > MOTOR_FULL) duty = MOTOR_FULL;
+  inner = (int32_t)duty*(MOTOR_STEER_FULL - 2*s)/MOTOR_STEER_FULL;
+  if(steer < 0){
+    Motor_Drive(duty, inner);        // right turn: the right wheel is inside
+  }else{
+    Motor_Drive(inner, duty);
+  }
+}
+
+// ------------Motor_Brake------------
+// Short both motors through the drivers, which stops
+// the wheels much sooner than letting them coast.
+// Input: none
+// Output: none
+// Assumes: Motor_Init() has been called
+void Motor_Brake(void){
+  PWM_Set34(0, 0);             // 0% duty: both outputs low
+  Duty[MOTOR_LEFT] = Duty[MOTOR_RIGHT] = 0;
+  P3->OUT |= 0xC0;             // awake, so the low sides conduct
+}
+
+// ------------Motor_Coast------------
+// Let both wheels spin down freely: 0% duty with the
+// drivers asleep, their outputs open.  The same as
+// Motor_Stop().
+// Input: none
+// Output: none
+void Motor_Coast(void){
+  Motor_Stop();
+}
+
+// ------------Motor_SetFrequency------------
+// Start or restart the PWM timer.  Duties set by the
+// other functions keep their meaning at any frequency.
+// Input: hz PWM frequency
+// Output: duty steps at that frequency, 0 if hz is too high
+uint16_t Motor_SetFrequency(uint32_t hz){
+  return PWM_InitHz(hz);      // both motors at 0% until the next command
+}
+
+// ------------Motor_GetDuty------------
+// Input: wheel MOTOR_LEFT or MOTOR_RIGHT
+// Output: duty last commanded, negative backward
+int16_t Motor_GetDuty(uint8_t wheel){
+  return Duty[wheel];
+}
+
+// ------------Motor_SetTable------------
+// Copy a table, forcing each wheel's speeds to be
+// non-decreasing so the inverse is well defined.
+void Motor_SetTable(const struct Motor_Table *table){
+  uint8_t w, k;
+  Valid = 0;
+  if(table == 0){
+    return;
+  }
+  Table = *table;
+  for(w = 0; w < 2; w++){
+    for(k = 1; k < MOTOR_POINTS; k++){
+      if(Table.Speed[w][k] < Table.Speed[w][k-1]){
+        Table.Speed[w][k] = Table.Speed[w][k-1];
+      }
+    }
+  }
+  Top = Table.Speed[MOTOR_LEFT][MOTOR_POINTS-1];
+  if(Table.Speed[MOTOR_RIGHT][MOTOR_POINTS-1] < Top){
+    Top = Table.Speed[MOTOR_RIGHT][MOTOR_POINTS-1];
+  }
+  Table.Magic = MOTOR_MAGIC;
+  Table.Check = checksum(&Table);
+  Valid = (Top > 0);           // a wheel that never moved is no table
+}
+
+// ------------Motor_LoadTable------------
+uint8_t Motor_LoadTable(void){
+  const struct Motor_Table *saved = (const struct Motor_Table *)MOTOR_TABLE;
+  if((saved->Magic != MOTOR_MAGIC) || (saved->Check != checksum(saved))){
+    return 0;
+  }
+  Motor_SetTable(saved);
+  return Valid;
+}
+
+// ------------Motor_SaveTable------------
+uint8_t Motor_SaveTable(void){
+  if(Valid == 0){
+    return 1;
+  }
+  if(Flash_Erase(MOTOR_TABLE)){
+    return 1;
+  }
+  return Flash_Write(MOTOR_TABLE, (const uint32_t *)&Table, sizeof(Table)/4);
+}
+
+// ------------Motor_GetTable------------
+const struct Motor_Table *Motor_GetTable(void){
+  return Valid ? &Table : 0;
+}
 
+// ------------Motor_Linearize------------
+void Motor_Linearize(uint8_t on){
+  Linear = on;
 }
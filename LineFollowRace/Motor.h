@@ -139,4 +139,158 @@ void Motor_Left(uint16_t leftDuty, uint16_t rightDuty);
  */
 void Motor_Backward(uint16_t leftDuty, uint16_t rightDuty);
 
+/**
+ * \brief 100% duty in the Motor_ functions, whatever the PWM frequency
+ */
+#define MOTOR_FULL 14998
+/**
+ * \brief Motor_Steer() command for a spin in place; half of it stops the inner wheel
+ */
+#define MOTOR_STEER_FULL 1000
+
+/**
+ * Run each wheel forward or backward on its own.  A wheel at 0% is
+ * braked, since the driver shorts the motor whenever its PWM is low.
+ * @param leftDuty  duty cycle of left wheel (-14,998 to 14,998), negative backward
+ * @param rightDuty duty cycle of right wheel (-14,998 to 14,998), negative backward
+ * @return none
+ * @note Assumes Motor_Init() has been called
+ * @brief  Drive each wheel with a signed duty
+ */
+void Motor_Drive(int16_t leftDuty, int16_t rightDuty);
+
+/**
+ * Drive along a curve.  The outer wheel runs at duty and the inner
+ * wheel at duty*(1 - 2|steer|/MOTOR_STEER_FULL): the same speed at 0,
+ * stopped at MOTOR_STEER_FULL/2, and backward beyond that, so the
+ * robot can turn tighter than about one wheel pivot, up to a spin in
+ * place at MOTOR_STEER_FULL.
+ * @param duty  duty cycle of the outer wheel (0 to 14,998)
+ * @param steer -MOTOR_STEER_FULL (right) to MOTOR_STEER_FULL (left), 0 straight
+ * @return none
+ * @note Assumes Motor_Init() has been called
+ * @brief  Drive with a continuous steering command
+ */
+void Motor_Steer(uint16_t duty, int16_t steer);
+
+/**
+ * Stop the wheels quickly: 0% duty with the drivers awake, so each
+ * motor is shorted through the low-side switches.
+ * @param none
+ * @return none
+ * @note Assumes Motor_Init() has been called
+ * @brief  Short-brake both motors
+ */
+void Motor_Brake(void);
+
+/**
+ * Let the wheels spin down freely: 0% duty with the drivers asleep
+ * and their outputs open.  Motor_Stop() does the same.
+ * @param none
+ * @return none
+ * @brief  Coast both motors
+ */
+void Motor_Coast(void);
+/**
+ * \brief default PWM frequency
+ */
+#define MOTOR_PWM_HZ 100
+
+/**
+ * Set the PWM frequency.  Until this is called the motors get no PWM.
+ * The motors are at 0% duty afterwards until the next Motor_Forward(),
+ * Motor_Right(), Motor_Left() or Motor_Backward().
+ * @param hz PWM frequency, for example MOTOR_PWM_HZ
+ * @return duty steps at that frequency, 0 if hz is too high (nothing changed)
+ * @note Call after Clock_Init48MHz(), since the timer divider is
+ * computed from the clock
+ * @brief  Start the motor PWM
+ */
+uint16_t Motor_SetFrequency(uint32_t hz);
+
+/**
+ * \brief wheel numbers in a Motor_Table, the same as TACH_LEFT and TACH_RIGHT
+ */
+#define MOTOR_LEFT  0
+#define MOTOR_RIGHT 1
+/**
+ * Duty as given to the last Motor_Forward(), Motor_Right(),
+ * Motor_Left(), Motor_Backward(), Motor_Drive() or Motor_Steer(),
+ * before linearization.
+ * @param wheel MOTOR_LEFT or MOTOR_RIGHT
+ * @return duty, 0 to 14,998 forward or negative backward; 0 after Motor_Stop() or Motor_Brake()
+ * @brief  Commanded duty
+ */
+int16_t Motor_GetDuty(uint8_t wheel);
+
+/**
+ * \brief duties measured in a Motor_Table
+ */
+#define MOTOR_POINTS 16
+
+/**
+ * \brief flash sector the Motor_Table is saved in, the first data sector (Flash.h)
+ */
+#define MOTOR_TABLE FLASH_DATA
+
+/**
+ * Measured wheel speed against duty, for linearization.  Kept in the
+ * MOTOR_TABLE sector.
+ */
+struct Motor_Table {
+  uint32_t Magic;                        // valid when MOTOR_MAGIC
+  uint16_t Duty[MOTOR_POINTS];           // duties swept, increasing, Duty[0] = 0
+  uint16_t Speed[2][MOTOR_POINTS];       // mm/s at each duty, per wheel, non-decreasing
+  uint32_t Check;                        // sum of all the words above
+};
+
+/**
+ * \brief marks a valid Motor_Table
+ */
+#define MOTOR_MAGIC 0x4D4F5431
+
+/**
+ * Use a table to linearize the duties given to Motor_Forward(),
+ * Motor_Right(), Motor_Left() and Motor_Backward().  With a table,
+ * a duty d asks for speed d/14,998 of the top speed both wheels can
+ * reach; each wheel gets the duty its table says gives that speed,
+ * which also steps over the dead band at low duty.
+ * @param table measured table, or 0 to drive the duties unchanged
+ * @return none
+ * @brief  Set the linearization table
+ */
+void Motor_SetTable(const struct Motor_Table *table);
+
+/**
+ * Load the table saved in flash, if there is a valid one.
+ * @param none
+ * @return 1 if loaded, 0 if not
+ * @brief  Restore the linearization table
+ */
+uint8_t Motor_LoadTable(void);
+
+/**
+ * Write the table in use to the MOTOR_TABLE sector.
+ * @param none
+ * @return 0 on success, 1 if there is no table or flash failed
+ * @note The robot should be parked; the CPU stalls while flash is erased
+ * @brief  Save the linearization table
+ */
+uint8_t Motor_SaveTable(void);
+
+/**
+ * @param none
+ * @return the table in use, or 0 if there is none
+ * @brief  Linearization table
+ */
+const struct Motor_Table *Motor_GetTable(void);
+
+/**
+ * Turn linearization on or off without losing the table.
+ * @param on 1 to linearize when there is a table, 0 for plain duties
+ * @return none
+ * @brief  Enable linearization
+ */
+void Motor_Linearize(uint8_t on);
+
 #endif /* MOTOR_H_ */
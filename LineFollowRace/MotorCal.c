@@ -0,0 +1,74 @@
+// MotorCal.c
+// Runs on MSP432
+// Sweeps the motor duty and measures wheel speed with the
+// encoders to build the motor linearization table.
+
+#include <stdint.h>
+#include "Motor.h"
+#include "Tach.h"
+#include "MotorCal.h"
+
+enum Phase {IDLE, SETTLE, MEASURE};
+
+static volatile uint8_t Requested;
+static enum Phase Phase = IDLE;
+static uint8_t Point;            // index of the duty being measured
+static uint32_t Since;           // ms the phase started
+static int32_t From[2];          // encoder counts at the start of the window
+static struct Motor_Table Result;
+
+// ------------drive------------
+// Start the next point.
+static void drive(uint32_t ms){
+  Result.Duty[Point] = (uint32_t)Point*MOTOR_FULL/(MOTOR_POINTS-1);
+  Motor_Forward(Result.Duty[Point], Result.Duty[Point]);
+  Phase = SETTLE;
+  Since = ms;
+}
+
+// ------------MotorCal_Start------------
+void MotorCal_Start(void){
+  Requested = 1;
+}
+
+// ------------MotorCal_Step------------
+// The speed is the encoder count over the window, so a
+// wheel wired backward still measures its speed.
+uint8_t MotorCal_Step(uint32_t ms){
+  int32_t edges;
+  uint8_t w;
+  if(Phase == IDLE){
+    if(Requested == 0){
+      return 0;
+    }
+    Requested = 0;
+    Motor_SetTable(0);           // plain duties while measuring
+    Point = 0;
+    drive(ms);
+  }else if(Phase == SETTLE){
+    if((ms - Since) >= MOTORCAL_SETTLE_MS){
+      From[MOTOR_LEFT] = Tach_Count(TACH_LEFT);
+      From[MOTOR_RIGHT] = Tach_Count(TACH_RIGHT);
+      Phase = MEASURE;
+      Since = ms;
+    }
+  }else if((ms - Since) >= MOTORCAL_MEASURE_MS){
+    for(w = 0; w < 2; w++){
+      edges = Tach_Count(w == MOTOR_LEFT ? TACH_LEFT : TACH_RIGHT) - From[w];
+      if(edges < 0){
+        edges = -edges;
+      }
+      Result.Speed[w][Point] = (uint32_t)edges*TACH_UM_PER_EDGE/(ms - Since);   // um/ms is mm/s
+    }
+    Point++;
+    if(Point < MOTOR_POINTS){
+      drive(ms);
+    }else{
+      Motor_Stop();
+      Motor_SetTable(&Result);
+      Phase = IDLE;
+      return 1;                  // this step still belonged to the sweep
+    }
+  }
+  return 1;
+}
@@ -0,0 +1,50 @@
+#ifndef MOTORCAL_H_
+#define MOTORCAL_H_
+
+/**
+ * @file      MotorCal.h
+ * @brief     Motor characterization sweep
+ * @details   Drives both wheels forward at MOTOR_POINTS duties from 0
+ * to 14,998, waits for each to settle, and measures the speed of each
+ * wheel from its encoder count over a fixed window.  The result
+ * becomes the Motor_Table in use; "msave" keeps it in flash.<br>
+ * The sweep runs a little each control step and owns the motors while
+ * it runs, so the robot should be on a stand with its wheels free.
+ * It takes about MOTOR_POINTS*(MOTORCAL_SETTLE_MS+MOTORCAL_MEASURE_MS).
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup RSLK_Input_Output
+ * @brief
+ * @{*/
+
+/**
+ * \brief ms to let the speed settle at each duty
+ */
+#define MOTORCAL_SETTLE_MS  400
+/**
+ * \brief ms of encoder counts averaged at each duty
+ */
+#define MOTORCAL_MEASURE_MS 300
+
+/**
+ * Ask for a sweep.  It starts at the next MotorCal_Step().
+ * @param  none
+ * @return none
+ * @note   May be called from any task
+ * @brief  Request a sweep
+ */
+void MotorCal_Start(void);
+
+/**
+ * Advance the sweep, if one is running or requested.
+ * @param  ms current time in ms, OS_Time()
+ * @return 1 while the sweep owns the motors, 0 otherwise
+ * @note   Assumes Tach_Init() has been called
+ * @brief  Run the sweep for one control step
+ */
+uint8_t MotorCal_Step(uint32_t ms);
+
+#endif /* MOTORCAL_H_ */
@@ -0,0 +1,291 @@
+// OS.c
+// Runs on MSP432
+// Fixed-priority preemptive kernel: task control blocks,
+// scheduler, SysTick tick, event flags and queues.  The
+// context switch itself is PendSV_Handler in OSasm.asm.
+
+#include <stdint.h>
+#include "msp.h"
+#include "CortexM.h"
+#include "Stack.h"
+#include "OS.h"
+#include "Trace.h"
+
+#define READY    0
+#define SLEEPING 1
+#define BLOCKED  2
+
+struct Tcb {
+  uint32_t *Sp;             // saved stack pointer, must be first (OSasm.asm)
+  uint8_t Priority;         // 0 is highest
+  uint8_t State;            // READY, SLEEPING or BLOCKED
+  uint32_t Wake;            // tick to wake at when SLEEPING
+  struct OS_Flags *Wait;    // group waited on when BLOCKED, 0 forever
+  uint32_t Mask;            // events waited for
+  uint32_t Release;         // cycle counter when last made ready
+  uint32_t *Stack;          // bottom of the stack
+  uint32_t Words;           // size of the stack
+};
+
+struct Tcb Tcbs[OS_MAXTASKS];
+struct Tcb *RunPt;          // running task, 0 before launch (OSasm.asm)
+struct Tcb *NextPt;         // task PendSV_Handler switches to (OSasm.asm)
+static uint8_t NumTasks;
+static uint8_t Launched;
+static volatile uint32_t Ticks;
+
+#pragma DATA_ALIGN(IdleStack, 32)
+static uint32_t IdleStack[OS_MINSTACK];
+
+// ------------idle------------
+// Runs when no other task is ready.
+static void idle(void){
+  while(1){
+    WaitForInterrupt();
+  }
+}
+
+// ------------ready------------
+// Make a task ready and note when, for OS_SleepUntil.
+// Interrupts must be disabled.
+static void ready(struct Tcb *t){
+  t->State = READY;
+  t->Release = CycleCounter_Read();
+}
+
+// ------------schedule------------
+// Choose the highest-priority ready task and pend a
+// context switch if it is not the one running.  Among
+// equal priorities the running task stays, unless it is
+// yielding, in which case the next one in order runs.
+// Interrupts must be disabled.
+// Input: yield 1 if the running task gives way to its equals
+static void schedule(uint8_t yield){
+  struct Tcb *best = 0;
+  struct Tcb *t;
+  uint8_t start, n;
+  if((Launched == 0) || (RunPt == 0)){
+    return;                    // not started, or the first switch is pending
+  }
+  if((yield == 0) && (RunPt->State == READY)){
+    best = RunPt;
+  }
+  start = (RunPt - Tcbs) + 1;
+  for(n = 0; n < NumTasks; n++){
+    t = &Tcbs[(start + n)%NumTasks];
+    if((t->State == READY) && ((best == 0) || (t->Priority < best->Priority))){
+      best = t;
+    }
+  }
+  NextPt = best;               // never 0, the idle task is always ready
+  if(best != RunPt){
+    TRACE_BEGIN(TRACE_TASK + (best - Tcbs));
+    SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+  }
+}
+
+// ------------exited------------
+// A task function returned; block it for good.
+static void exited(void){
+  StartCritical();
+  RunPt->State = BLOCKED;
+  RunPt->Wait = 0;
+  schedule(0);
+  EnableInterrupts();
+  while(1){};
+}
+
+// ------------OS_Init------------
+void OS_Init(void){
+  NumTasks = 0;
+  Launched = 0;
+  Ticks = 0;
+  RunPt = 0;
+  NextPt = 0;
+  OS_AddTask(idle, 255, IdleStack, OS_MINSTACK);
+}
+
+// ------------OS_AddTask------------
+// Paint and guard the stack, then build an exception frame
+// on it so that the first switch to the task "returns"
+// into its function.
+// Input: task function, priority, stack and its size
+// Output: task number, or -1 on error
+int8_t OS_AddTask(void (*task)(void), uint8_t priority, uint32_t *stack, uint32_t words){
+  struct Tcb *t;
+  uint32_t *sp;
+  int i;
+  if((NumTasks >= OS_MAXTASKS) || (words < OS_MINSTACK) || ((uint32_t)stack & (STACK_GUARD-1))){
+    return -1;
+  }
+  Stack_Prepare(stack, words); // unguarded if the MPU regions have run out
+  t = &Tcbs[NumTasks];
+  sp = &stack[words & ~1];     // keep the frame 8-byte aligned
+  *(--sp) = 0x01000000;        // xPSR, Thumb state
+  *(--sp) = (uint32_t)task;    // PC
+  *(--sp) = (uint32_t)exited;  // LR
+  for(i = 0; i < 5; i++){
+    *(--sp) = 0;               // R12, R3, R2, R1, R0
+  }
+  *(--sp) = 0xFFFFFFFD;        // EXC_RETURN: thread mode, PSP, no FPU frame
+  for(i = 0; i < 8; i++){
+    *(--sp) = 0;               // R11 to R4
+  }
+  t->Sp = sp;
+  t->Priority = priority;
+  t->State = READY;
+  t->Wait = 0;
+  t->Release = 0;
+  t->Stack = stack;
+  t->Words = words;
+  NumTasks++;
+  return NumTasks - 1;
+}
+
+// ------------OS_Launch------------
+// PendSV runs last of all exceptions, SysTick just above
+// it, so every hardware interrupt can preempt the kernel.
+void OS_Launch(void){
+  DisableInterrupts();
+  NVIC_SetPriority(PendSV_IRQn, 7);
+  NVIC_SetPriority(SysTick_IRQn, 6);
+  SysTick->LOAD = OS_TICK - 1;
+  SysTick->VAL = 0;
+  SysTick->CTRL = 0x00000007;  // core clock, interrupts, enable
+  Launched = 1;
+  RunPt = &Tcbs[NumTasks - 1]; // so the search starts at task 0
+  schedule(1);
+  RunPt = 0;                   // PendSV_Handler has no context to save
+  SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+  EnableInterrupts();          // the switch happens here
+  while(1){};
+}
+
+// ------------OS_Time------------
+uint32_t OS_Time(void){
+  return Ticks;
+}
+
+// ------------SysTick_Handler------------
+// Kernel tick: wake the tasks whose sleep has ended.
+void SysTick_Handler(void){
+  struct Tcb *t;
+  uint8_t i;
+  long sr = StartCritical();   // higher-priority ISRs may set flags
+  TRACE_BEGIN(TRACE_SYSTICK);
+  Ticks++;
+  for(i = 0; i < NumTasks; i++){
+    t = &Tcbs[i];
+    if((t->State == SLEEPING) && ((int32_t)(Ticks - t->Wake) >= 0)){
+      ready(t);
+    }
+  }
+  schedule(0);
+  TRACE_END(TRACE_SYSTICK);
+  EndCritical(sr);
+}
+
+// ------------OS_Sleep------------
+void OS_Sleep(uint32_t ticks){
+  long sr = StartCritical();
+  if(ticks){
+    RunPt->State = SLEEPING;
+    RunPt->Wake = Ticks + ticks;
+    schedule(0);
+  }else{
+    schedule(1);
+  }
+  EndCritical(sr);             // the switch happens here
+}
+
+// ------------OS_SleepUntil------------
+// Input: last previous release tick, updated
+//        period ticks between releases
+// Output: cycles from release to running
+uint32_t OS_SleepUntil(uint32_t *last, uint32_t period){
+  long sr = StartCritical();
+  *last += period;
+  if((int32_t)(Ticks - *last) < 0){
+    RunPt->State = SLEEPING;
+    RunPt->Wake = *last;
+    schedule(0);
+  }else{
+    *last = Ticks;             // overran, restart the schedule from now
+    RunPt->Release = CycleCounter_Read();
+  }
+  EndCritical(sr);
+  return CycleCounter_Read() - RunPt->Release;
+}
+
+// ------------OS_FlagSet------------
+void OS_FlagSet(struct OS_Flags *flags, uint32_t mask){
+  struct Tcb *t;
+  uint8_t i;
+  long sr = StartCritical();
+  flags->Bits |= mask;
+  for(i = 0; i < NumTasks; i++){
+    t = &Tcbs[i];
+    if((t->State == BLOCKED) && (t->Wait == flags) && (t->Mask & mask)){
+      ready(t);
+    }
+  }
+  schedule(0);
+  EndCritical(sr);
+}
+
+// ------------OS_FlagWait------------
+uint32_t OS_FlagWait(struct OS_Flags *flags, uint32_t mask){
+  uint32_t got;
+  long sr = StartCritical();
+  while((flags->Bits & mask) == 0){
+    RunPt->State = BLOCKED;
+    RunPt->Wait = flags;
+    RunPt->Mask = mask;
+    schedule(0);
+    EndCritical(sr);           // the switch happens here
+    sr = StartCritical();
+  }
+  got = flags->Bits & mask;
+  flags->Bits &= ~got;
+  EndCritical(sr);
+  return got;
+}
+
+// ------------OS_QueueInit------------
+void OS_QueueInit(struct OS_Queue *q, uint32_t *buf, uint32_t depth){
+  q->Buf = buf;
+  q->Depth = depth;
+  q->Put = q->Get = 0;
+  q->Lost = 0;
+  q->Ready.Bits = 0;
+}
+
+// ------------OS_QueuePut------------
+uint8_t OS_QueuePut(struct OS_Queue *q, uint32_t item){
+  long sr = StartCritical();
+  if((q->Put - q->Get) >= q->Depth){
+    q->Lost++;
+    EndCritical(sr);
+    return 0;
+  }
+  q->Buf[q->Put%q->Depth] = item;
+  q->Put++;
+  EndCritical(sr);
+  OS_FlagSet(&q->Ready, 1);
+  return 1;
+}
+
+// ------------OS_QueueGet------------
+uint32_t OS_QueueGet(struct OS_Queue *q){
+  uint32_t item;
+  long sr = StartCritical();
+  while(q->Put == q->Get){
+    EndCritical(sr);
+    OS_FlagWait(&q->Ready, 1);
+    sr = StartCritical();
+  }
+  item = q->Buf[q->Get%q->Depth];
+  q->Get++;
+  EndCritical(sr);
+  return item;
+}
@@ -0,0 +1,161 @@
+#ifndef OS_H_
+#define OS_H_
+
+/**
+ * @file      OS.h
+ * @brief     Small fixed-priority preemptive kernel
+ * @details   Tasks are added with OS_AddTask() before OS_Launch() and
+ * never exit.  The highest-priority ready task always runs; equal
+ * priorities are not time-sliced, so a task keeps the CPU until it
+ * blocks or a higher-priority task becomes ready.  Tasks block only in
+ * OS_Sleep(), OS_SleepUntil(), OS_FlagWait() and OS_QueueGet().<br>
+ * There are no locks that a task can hold while blocked.  Flags and
+ * queues protect their data with critical sections a few instructions
+ * long, so a low-priority task can never hold up a high-priority one
+ * beyond that, which keeps the control task's latency independent of
+ * the other tasks' load.<br>
+ * SysTick_Handler runs the 1 ms tick and PendSV_Handler (OSasm.asm)
+ * switches tasks, saving the FPU registers only for tasks that use
+ * the FPU.  Once OS_Launch() runs, SysTick belongs to the kernel, so
+ * the SysTick_Wait() functions must not be called.
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup MSP432
+ * @brief
+ * @{*/
+
+/**
+ * \brief most tasks, including the idle task
+ */
+#define OS_MAXTASKS 8
+/**
+ * \brief core clock cycles in one tick, 1 ms at 48 MHz
+ */
+#define OS_TICK 48000
+/**
+ * \brief smallest task stack in 32-bit words
+ */
+#define OS_MINSTACK 64
+
+/**
+ * Event flags, up to 32 events per group.  Set from tasks or ISRs.
+ */
+struct OS_Flags {
+  volatile uint32_t Bits;
+};
+
+/**
+ * Bounded queue of 32-bit items.  OS_QueuePut() never blocks, so
+ * ISRs may use it; a full queue drops the item and counts it.
+ */
+struct OS_Queue {
+  uint32_t *Buf;            // Depth items
+  uint32_t Depth;
+  volatile uint32_t Put;    // items ever put
+  volatile uint32_t Get;    // items ever taken
+  volatile uint32_t Lost;   // items dropped on a full queue
+  struct OS_Flags Ready;    // bit 0 set when an item is put
+};
+
+/**
+ * Reset the kernel and add the idle task.
+ * @param  none
+ * @return none
+ * @brief  Initialize the kernel
+ */
+void OS_Init(void);
+
+/**
+ * Add a task.  Call before OS_Launch().
+ * @param  task function that never returns
+ * @param  priority 0 is highest; 255 is taken by the idle task
+ * @param  stack task stack, 32-byte aligned; its lowest 32 bytes become a guard (Stack.h)
+ * @param  words size of the stack, at least OS_MINSTACK
+ * @return task number, or -1 if there is no room or the stack is too small
+ * @brief  Add a task
+ */
+int8_t OS_AddTask(void (*task)(void), uint8_t priority, uint32_t *stack, uint32_t words);
+
+/**
+ * Start SysTick and run the highest-priority task.  Does not return.
+ * @param  none
+ * @return none
+ * @note   Assumes Clock_Init48MHz() has been called
+ * @brief  Start the kernel
+ */
+void OS_Launch(void);
+
+/**
+ * @param  none
+ * @return ticks since OS_Launch()
+ * @brief  Kernel time
+ */
+uint32_t OS_Time(void);
+
+/**
+ * Block the calling task for a number of ticks.
+ * @param  ticks 0 just lets other ready tasks of the same priority run
+ * @return none
+ * @brief  Sleep
+ */
+void OS_Sleep(uint32_t ticks);
+
+/**
+ * Block until period ticks after the previous release, for periodic
+ * tasks that must not drift.  If that time has already passed the
+ * task is released at once.
+ * @param  last previous release time, updated to this one
+ * @param  period ticks between releases
+ * @return core clock cycles from the tick that released the task until it ran
+ * @brief  Periodic sleep
+ */
+uint32_t OS_SleepUntil(uint32_t *last, uint32_t period);
+
+/**
+ * @param  flags group to set in
+ * @param  mask events to set
+ * @return none
+ * @note   May be called from an ISR
+ * @brief  Signal events
+ */
+void OS_FlagSet(struct OS_Flags *flags, uint32_t mask);
+
+/**
+ * Block until any event in mask is set, then clear and return those set.
+ * @param  flags group to wait on
+ * @param  mask events of interest
+ * @return events in mask that were set
+ * @brief  Wait for events
+ */
+uint32_t OS_FlagWait(struct OS_Flags *flags, uint32_t mask);
+
+/**
+ * @param  q queue
+ * @param  buf storage for depth items
+ * @param  depth number of items
+ * @return none
+ * @brief  Initialize a queue
+ */
+void OS_QueueInit(struct OS_Queue *q, uint32_t *buf, uint32_t depth);
+
+/**
+ * @param  q queue
+ * @param  item value to put
+ * @return 1 if put, 0 if the queue was full
+ * @note   May be called from an ISR
+ * @brief  Put an item without blocking
+ */
+uint8_t OS_QueuePut(struct OS_Queue *q, uint32_t item);
+
+/**
+ * Block until the queue has an item and take it.
+ * @param  q queue
+ * @return the oldest item
+ * @brief  Take an item
+ */
+uint32_t OS_QueueGet(struct OS_Queue *q);
+
+#endif /* OS_H_ */
@@ -0,0 +1,52 @@
+;/*****************************************************************************/
+; OSasm.asm
+; Runs on MSP432
+; Context switch for the kernel in OS.c, written in assembly
+; because it works directly on the process stack pointer.
+; Tasks run in thread mode on PSP; handlers run on MSP.
+
+        .thumb
+        .text
+        .align 2
+
+        .global RunPt            ; currently running task, 0 before launch
+        .global NextPt           ; task chosen by the scheduler
+        .global PendSV_Handler
+
+RunPtAddr   .field RunPt,32
+NextPtAddr  .field NextPt,32
+
+;*********** PendSV_Handler ************************
+; Save R4-R11, EXC_RETURN and, if the task has used the FPU
+; (EXC_RETURN bit 4 clear), S16-S31 on the running task's
+; stack, then restore the same from NextPt's stack.  The
+; hardware has already stacked R0-R3, R12, LR, PC, xPSR and,
+; for FPU tasks, S0-S15 and FPSCR.
+; Saved frame, from the stack pointer stored in the TCB up:
+;   R4-R11, EXC_RETURN, [S16-S31], hardware frame
+PendSV_Handler:  .asmfunc
+        CPSID   I                ; SysTick may change NextPt
+        LDR     R2, RunPtAddr    ; R2 = &RunPt
+        LDR     R1, [R2]         ; R1 = RunPt
+        CBZ     R1, Restore      ; first switch, nothing to save
+        MRS     R0, PSP
+        TST     LR, #0x10        ; bit 4 clear means an FPU frame
+        IT      EQ
+        VSTMDBEQ R0!, {S16-S31}
+        STMDB   R0!, {R4-R11, LR}
+        STR     R0, [R1]         ; RunPt->Sp = R0
+Restore:
+        LDR     R3, NextPtAddr
+        LDR     R1, [R3]         ; R1 = NextPt
+        STR     R1, [R2]         ; RunPt = NextPt
+        LDR     R0, [R1]         ; R0 = RunPt->Sp
+        LDMIA   R0!, {R4-R11, LR}
+        TST     LR, #0x10
+        IT      EQ
+        VLDMIAEQ R0!, {S16-S31}
+        MSR     PSP, R0
+        CPSIE   I
+        BX      LR               ; EXC_RETURN unstacks the rest
+        .endasmfunc
+
+        .end
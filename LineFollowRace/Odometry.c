@@ -0,0 +1,220 @@
+// Odometry.c
+// Runs on MSP432
+// Integrates the encoder counts into a pose in integer
+// arithmetic and keeps a map of curvature along the lap.
+// Centered on a straight line, the encoders' turn is drift
+// and is kept out of the heading.
+
+#include <stdint.h>
+#include "Tach.h"
+#include "Reflectance.h"
+#include "Odometry.h"
+
+#define TURN 4294967296LL      // heading units in one turn
+
+// sin(i*90/256 degrees) in Q15, i = 0 to 256
+static const int16_t Sine[257] = {
+      0,   201,   402,   603,   804,  1005,  1206,  1407,  1608,  1809,  2009,  2210,  2410,  2611,  2811,  3012,
+   3212,  3412,  3612,  3811,  4011,  4210,  4410,  4609,  4808,  5007,  5205,  5404,  5602,  5800,  5998,  6195,
+   6393,  6590,  6786,  6983,  7179,  7375,  7571,  7767,  7962,  8157,  8351,  8545,  8739,  8933,  9126,  9319,
+   9512,  9704,  9896, 10087, 10278, 10469, 10659, 10849, 11039, 11228, 11417, 11605, 11793, 11980, 12167, 12353,
+  12539, 12725, 12910, 13094, 13279, 13462, 13645, 13828, 14010, 14191, 14372, 14553, 14732, 14912, 15090, 15269,
+  15446, 15623, 15800, 15976, 16151, 16325, 16499, 16673, 16846, 17018, 17189, 17360, 17530, 17700, 17869, 18037,
+  18204, 18371, 18537, 18703, 18868, 19032, 19195, 19357, 19519, 19680, 19841, 20000, 20159, 20317, 20475, 20631,
+  20787, 20942, 21096, 21250, 21403, 21554, 21705, 21856, 22005, 22154, 22301, 22448, 22594, 22739, 22884, 23027,
+  23170, 23311, 23452, 23592, 23731, 23870, 24007, 24143, 24279, 24413, 24547, 24680, 24811, 24942, 25072, 25201,
+  25329, 25456, 25582, 25708, 25832, 25955, 26077, 26198, 26319, 26438, 26556, 26674, 26790, 26905, 27019, 27133,
+  27245, 27356, 27466, 27575, 27683, 27790, 27896, 28001, 28105, 28208, 28310, 28411, 28510, 28609, 28706, 28803,
+  28898, 28992, 29085, 29177, 29268, 29358, 29447, 29534, 29621, 29706, 29791, 29874, 29956, 30037, 30117, 30195,
+  30273, 30349, 30424, 30498, 30571, 30643, 30714, 30783, 30852, 30919, 30985, 31050, 31113, 31176, 31237, 31297,
+  31356, 31414, 31470, 31526, 31580, 31633, 31685, 31736, 31785, 31833, 31880, 31926, 31971, 32014, 32057, 32098,
+  32137, 32176, 32213, 32250, 32285, 32318, 32351, 32382, 32412, 32441, 32469, 32495, 32521, 32545, 32567, 32589,
+  32609, 32628, 32646, 32663, 32678, 32692, 32705, 32717, 32728, 32737, 32745, 32752, 32757, 32761, 32765, 32766,
+  32767
+};
+
+static struct Odometry_Pose Pose;
+static int32_t LastLeft, LastRight;
+static uint32_t Gain;          // heading units per edge of difference
+static int64_t Turned;         // heading change since the marker, not wrapped
+static uint32_t Track;         // um since the marker
+static int32_t WindowTurn;     // heading change over the curvature window
+static int32_t WindowUm;       // travel over the curvature window
+static int32_t Curvature;      // 1/km, last full window
+static uint16_t Map[2][ODOMETRY_BINS];   // |curvature| per bin, 1/km
+static uint8_t Recording;      // Map[Recording] is this lap, the other the last lap
+static uint8_t Markers;        // markers seen, up to 2
+static uint8_t Centered;       // 1 if the last line position was near the middle
+static uint32_t CenteredUm;    // travel since the line came to the middle
+static int32_t Drift;          // turn kept out of the heading since the marker
+
+// ------------sine------------
+// Input: angle 2^32 per turn
+// Output: sin(angle) in Q15
+static int32_t sine(uint32_t angle){
+  uint32_t i = (angle + (1u<<21))>>22;   // nearest of 1024 steps
+  uint32_t step = i&255;
+  switch((i>>8)&3){
+    case 0:  return Sine[step];
+    case 1:  return Sine[256-step];
+    case 2:  return -Sine[step];
+    default: return -Sine[256-step];
+  }
+}
+
+// ------------clear------------
+static void clear(uint16_t *map){
+  uint32_t i;
+  for(i = 0; i < ODOMETRY_BINS; i++){
+    map[i] = 0;
+  }
+}
+
+// ------------Odometry_Init------------
+void Odometry_Init(int32_t left, int32_t right){
+  Pose.X = Pose.Y = 0;
+  Pose.Heading = 0;
+  LastLeft = left;
+  LastRight = right;
+  Gain = ODOMETRY_GAIN;
+  Turned = 0;
+  Track = 0;
+  WindowTurn = WindowUm = 0;
+  Curvature = 0;
+  clear(Map[0]);
+  clear(Map[1]);
+  Recording = 0;
+  Markers = 0;
+  Centered = 0;
+  CenteredUm = 0;
+  Drift = 0;
+}
+
+// ------------Odometry_Update------------
+// Curvature in 1/km is turn/travel scaled by
+// 2 pi 10^9/2^32 = 1.46292 for these units.  The map
+// keeps the encoders' turn even where the heading does not.
+void Odometry_Update(int32_t left, int32_t right){
+  int32_t dl = left - LastLeft;
+  int32_t dr = right - LastRight;
+  int32_t ds = (dl + dr)*TACH_UM_PER_EDGE/2;
+  int32_t turn = (int32_t)((int64_t)(dr - dl)*Gain);
+  int32_t heading = turn;      // the part of it that turns the pose
+  uint32_t mid;
+  uint32_t bin;
+  LastLeft = left;
+  LastRight = right;
+  if(Centered){
+    CenteredUm += (ds < 0) ? -ds : ds;
+    if((CenteredUm >= ODOMETRY_SETTLE_UM) &&
+       (Curvature <= ODOMETRY_STRAIGHT_K) && (Curvature >= -ODOMETRY_STRAIGHT_K)){
+      Drift += turn;           // straight and on the line: not a real turn
+      heading = 0;
+    }
+  }
+  mid = Pose.Heading + heading/2;
+  Pose.X += (int32_t)(((int64_t)ds*sine(mid + (uint32_t)(TURN/4)) + (1<<14))>>15);   // cos, rounded
+  Pose.Y += (int32_t)(((int64_t)ds*sine(mid) + (1<<14))>>15);
+  Pose.Heading += heading;
+  Turned += heading;
+  if(ds > 0){
+    Track += ds;
+  }
+  WindowTurn += turn;
+  WindowUm += (((dl < 0) ? -dl : dl) + ((dr < 0) ? -dr : dr))*TACH_UM_PER_EDGE/2;   // counts turning on the spot
+  if(WindowUm >= ODOMETRY_WINDOW_UM){
+    Curvature = (int32_t)(((int64_t)WindowTurn*146292)/((int64_t)WindowUm*100000));
+    WindowTurn = WindowUm = 0;
+    bin = Track/ODOMETRY_BIN_UM;
+    if(bin < ODOMETRY_BINS){
+      uint32_t k = (Curvature < 0) ? -Curvature : Curvature;
+      if(k > 0xFFFF){
+        k = 0xFFFF;
+      }
+      if(k > Map[Recording][bin]){
+        Map[Recording][bin] = k;
+      }
+    }
+  }
+}
+
+// ------------Odometry_Line------------
+// Input: position line position, um
+void Odometry_Line(int32_t position){
+  if((position != REFLECTANCE_NOLINE) &&
+     (position <= ODOMETRY_CENTER_UM) && (position >= -ODOMETRY_CENTER_UM)){
+    Centered = 1;
+  }else{
+    Centered = 0;
+    CenteredUm = 0;            // off the middle: settle again
+  }
+}
+
+// ------------Odometry_Marker------------
+// A closed lap has turned a whole number of turns.  If the
+// count is near one, scale the gain so it would have been
+// exact; a figure eight turns zero and corrects nothing.
+void Odometry_Marker(void){
+  int64_t turns, target, error, limit;
+  if(Markers){
+    turns = (Turned + ((Turned < 0) ? -TURN/2 : TURN/2))/TURN;
+    target = turns*TURN;
+    error = Turned - target;
+    limit = ((target < 0) ? -target : target)/8;     // more than 45 degrees off is not this lap's fault
+    if(turns && (error < limit) && (error > -limit)){
+      Gain = (uint32_t)(((int64_t)Gain*target)/Turned);
+    }
+    Recording ^= 1;            // this lap becomes the map ahead
+    clear(Map[Recording]);
+  }
+  if(Markers < 2){
+    Markers++;
+  }
+  Pose.X = Pose.Y = 0;
+  Pose.Heading = 0;
+  Turned = 0;
+  Track = 0;
+  Drift = 0;
+}
+
+// ------------Odometry_Get------------
+const struct Odometry_Pose *Odometry_Get(void){
+  return &Pose;
+}
+
+// ------------Odometry_Track------------
+uint32_t Odometry_Track(void){
+  return Track;
+}
+
+// ------------Odometry_Curvature------------
+int32_t Odometry_Curvature(void){
+  return Curvature;
+}
+
+// ------------Odometry_Ahead------------
+int32_t Odometry_Ahead(uint32_t um){
+  const uint16_t *map = Map[Recording^1];
+  uint32_t bin = Track/ODOMETRY_BIN_UM;
+  uint32_t end = (Track + um)/ODOMETRY_BIN_UM;
+  int32_t most = 0;
+  if(Markers < 2){
+    return -1;                 // no complete lap yet
+  }
+  for(; (bin <= end) && (bin < ODOMETRY_BINS); bin++){
+    if(map[bin] > most){
+      most = map[bin];
+    }
+  }
+  return most;
+}
+
+// ------------Odometry_Drift------------
+int32_t Odometry_Drift(void){
+  return Drift;
+}
+
+// ------------Odometry_Gain------------
+uint32_t Odometry_Gain(void){
+  return Gain;
+}
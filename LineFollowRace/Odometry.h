@@ -0,0 +1,156 @@
+#ifndef ODOMETRY_H_
+#define ODOMETRY_H_
+
+/**
+ * @file      Odometry.h
+ * @brief     Fixed-point dead reckoning from the wheel encoders
+ * @details   Odometry_Update() is called once per control step with the
+ * encoder counts.  The robot moves the mean of the two wheels' travel
+ * along the heading halfway through the turn between the wheels, so
+ * each step costs two table lookups and no floating point.  Position
+ * is in micrometers and heading in binary angle units, 2^32 per turn,
+ * so heading wraps for free.<br>
+ * The start/finish marker is the one place on the track seen the same
+ * way every lap.  Odometry_Marker() puts the pose back at the origin
+ * there, and uses the heading turned since the last marker, which
+ * should be a whole number of turns, to correct the heading gain for
+ * the real wheel spacing and wheel slip.<br>
+ * Between markers the line itself corrects the heading.  On a straight
+ * with the line held under the middle of the sensor bar, the robot is
+ * not turning relative to the line, so whatever turn the encoders report
+ * there is wheel slip or mismatch.  Odometry_Line() is given each line
+ * position; once the robot has stayed centered for ODOMETRY_SETTLE_UM on
+ * a path straighter than ODOMETRY_STRAIGHT_K, the turn is kept out of
+ * the heading, and totalled as the drift removed.<br>
+ * The path curvature is also recorded by distance along the lap, so
+ * from the second lap on Odometry_Ahead() can tell the speed planner
+ * how sharp the track gets just ahead.
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup MSP432
+ * @brief
+ * @{*/
+
+/**
+ * \brief heading units per encoder edge of difference between the
+ * wheels: TACH_UM_PER_EDGE/(2 pi 140 mm wheel spacing) turns, times 2^32
+ */
+#define ODOMETRY_GAIN 2983274
+/**
+ * \brief travel over which one curvature value is measured, um
+ */
+#define ODOMETRY_WINDOW_UM 20000
+/**
+ * \brief length of one bin of the curvature map, um
+ */
+#define ODOMETRY_BIN_UM 50000
+/**
+ * \brief bins in the curvature map, 6.4 m of track
+ */
+#define ODOMETRY_BINS 128
+
+/**
+ * \brief line positions within this of the middle of the bar are centered, um
+ */
+#define ODOMETRY_CENTER_UM 5000
+/**
+ * \brief travel centered on the line before the heading is held, um
+ */
+#define ODOMETRY_SETTLE_UM 50000
+/**
+ * \brief most |curvature| of a straight the heading is held on, 1/km
+ */
+#define ODOMETRY_STRAIGHT_K 500
+
+/**
+ * Where the robot is, relative to the last start/finish marker
+ */
+struct Odometry_Pose {
+  int32_t X;           // um, along the heading the robot had at the marker
+  int32_t Y;           // um, to the left of that
+  uint32_t Heading;    // 2^32 per turn, counterclockwise, 0 at the marker
+};
+
+/**
+ * Put the pose at the origin and take the encoder counts as the start.
+ * @param  left Tach_Count(TACH_LEFT)
+ * @param  right Tach_Count(TACH_RIGHT)
+ * @return none
+ * @brief  Initialize odometry
+ */
+void Odometry_Init(int32_t left, int32_t right);
+
+/**
+ * Move the pose by the wheel travel since the last call.
+ * @param  left Tach_Count(TACH_LEFT)
+ * @param  right Tach_Count(TACH_RIGHT)
+ * @return none
+ * @brief  Integrate one step
+ */
+void Odometry_Update(int32_t left, int32_t right);
+
+/**
+ * Where the line is under the sensor bar, for the heading correction.
+ * Takes effect from the next Odometry_Update().
+ * @param  position Reflectance_Position(), um, or REFLECTANCE_NOLINE
+ * @return none
+ * @brief  Line position
+ */
+void Odometry_Line(int32_t position);
+
+/**
+ * The robot is on the start/finish marker: close the lap, correct the
+ * heading gain, and keep this lap's curvature map for Odometry_Ahead().
+ * @param  none
+ * @return none
+ * @brief  Close a lap
+ */
+void Odometry_Marker(void);
+
+/**
+ * @param  none
+ * @return current pose
+ * @brief  Pose
+ */
+const struct Odometry_Pose *Odometry_Get(void);
+
+/**
+ * @param  none
+ * @return um travelled since the last marker
+ * @brief  Position along the track
+ */
+uint32_t Odometry_Track(void);
+
+/**
+ * @param  none
+ * @return curvature over the last ODOMETRY_WINDOW_UM, 1/km, positive turning left
+ * @brief  Path curvature
+ */
+int32_t Odometry_Curvature(void);
+
+/**
+ * Sharpest curvature the previous lap had between here and um ahead.
+ * @param  um look-ahead distance
+ * @return largest |curvature| in 1/km, or -1 before a full lap is mapped
+ * @brief  Curvature ahead
+ */
+int32_t Odometry_Ahead(uint32_t um);
+
+/**
+ * @param  none
+ * @return heading turn kept out of the pose since the last marker, 2^32 per turn
+ * @brief  Drift removed by the line
+ */
+int32_t Odometry_Drift(void);
+
+/**
+ * @param  none
+ * @return heading units per edge of wheel difference, ODOMETRY_GAIN corrected by each lap
+ * @brief  Heading gain
+ */
+uint32_t Odometry_Gain(void);
+
+#endif /* ODOMETRY_H_ */
@@ -1,5 +1,3 @@
-#ifndef PWM_H_
-#define PWM_H_
 
 // PWM.c
 // Runs on MSP432
@@ -48,6 +46,7 @@ policies, either expressed or implied, of the FreeBSD Project.
 */
 
 #include "msp.h"
+#include "Clock.h"
 #include "PWM.h"
 
 
@@ -141,4 +140,74 @@ void PWM_Duty4(uint16_t duty4){
   
 }
 
-#endif
+static uint16_t Period;        // CCR0 from PWM_InitHz
+
+//***************************PWM_InitHz*******************************
+// PWM outputs on P2.6, P2.7 at a frequency in Hz, both
+// starting at 0% duty.  TIMER_A0 counts up to CCR0 and
+// back down, so the output frequency is
+//   f = source/(divider*2*CCR0)
+// The divider (ID times EX0, 1 to 64) is the smallest
+// that fits CCR0 in 16 bits, which gives the most duty
+// resolution.  SMCLK is used unless even /64 is too fast,
+// then ACLK.
+// Inputs:  hz output frequency
+// Outputs: CCR0, the number of duty steps; 0 if hz cannot be made
+// Assumes: MCLK and SMCLK come from the same oscillator
+//          (Clock_Init48MHz, or the 3 MHz DCO after reset)
+uint16_t PWM_InitHz(uint32_t hz){
+    static const uint8_t ID[4] = {1, 2, 4, 8};
+    uint32_t source = Clock_GetFreq()>>((CS->CTL1&0x70000000)>>28);   // SMCLK = MCLK/DIVS
+    uint32_t tassel = 0x0200;  // SMCLK
+    uint32_t counts = 0;
+    uint8_t id, ex;
+    if((hz == 0) || (source/(2*hz) < PWM_MINSTEPS)){
+        return 0;              // too fast for useful resolution
+    }
+    if(source/(64*2*hz) > 0xFFFF){
+        source = 32768;        // ACLK from REFOCLK, for very low rates
+        tassel = 0x0100;
+    }
+    for(id = 0; id < 4; id++){
+        for(ex = 1; ex <= 8; ex++){
+            counts = source/(ID[id]*ex*2*hz);
+            if(counts <= 0xFFFF){
+                break;
+            }
+        }
+        if(counts <= 0xFFFF){
+            break;
+        }
+    }
+    if((counts > 0xFFFF) || (counts < PWM_MINSTEPS)){
+        return 0;
+    }
+    P2->DIR |= 0xC0;           // P2.6, P2.7 TA0CCP3, TA0CCP4
+    P2->SEL0 |= 0xC0;
+    P2->SEL1 &= ~0xC0;
+    TIMER_A0->CTL &= ~0x0030;  // stop the timer before configuration
+    TIMER_A0->CCTL[0] = 0x0080;
+    TIMER_A0->CCR[0] = counts;
+    TIMER_A0->EX0 = ex - 1;    // bits2-0, divide by ex
+    TIMER_A0->CCTL[3] = 0x0040; // toggle/reset
+    TIMER_A0->CCR[3] = 0;
+    TIMER_A0->CCTL[4] = 0x0040;
+    TIMER_A0->CCR[4] = 0;
+    Period = counts;
+    // bits9-8, TASSEL; bits7-6, ID; bits5-4=11, up/down; bit2=1, clear
+    TIMER_A0->CTL = tassel|(id<<6)|0x0034;
+    return counts;
+}
+
+//***************************PWM_Set34*******************************
+// change both duty cycles, in fractions of PWM_FULL
+// Inputs:  duty3 duty on P2.6, 0 to PWM_FULL
+//          duty4 duty on P2.7, 0 to PWM_FULL
+// Outputs: none
+// Assumes: PWM_InitHz has been called
+void PWM_Set34(uint16_t duty3, uint16_t duty4){
+    if(duty3 > PWM_FULL) duty3 = PWM_FULL;
+    if(duty4 > PWM_FULL) duty4 = PWM_FULL;
+    TIMER_A0->CCR[3] = ((uint32_t)duty3*Period + PWM_FULL/2)>>15;
+    TIMER_A0->CCR[4] = ((uint32_t)duty4*Period + PWM_FULL/2)>>15;
+}
@@ -97,4 +97,38 @@ void PWM_Duty3(uint16_t duty3);
  */
 void PWM_Duty4(uint16_t duty4);
 
+/**
+ * \brief 100% duty for PWM_Set34(), Q15 so duties do not depend on the period
+ */
+#define PWM_FULL 32768
+/**
+ * \brief fewest duty steps PWM_InitHz() accepts
+ */
+#define PWM_MINSTEPS 100
+
+/**
+ * @details  Initialize PWM outputs on P2.6, P2.7 at a given frequency,
+ * both at 0% duty.  The clock source and the ID and EX0 dividers are
+ * chosen from Clock_GetFreq() to give the longest period that fits
+ * in TA0CCR0, which is the most duty resolution at that frequency.
+ * @remark   Counter counts up to TA0CCR0 and back down
+ * @remark   At 48 MHz (SMCLK 12 MHz): 100 Hz gives 60,000 steps, 1 kHz 6,000, 20 kHz 300
+ * @remark   Call again after the clock changes
+ * @param  hz output frequency
+ * @return number of duty steps (TA0CCR0), 0 if hz is too high for PWM_MINSTEPS steps
+ * @brief  PWM on P2.6, P2.7 at a frequency
+ */
+uint16_t PWM_InitHz(uint32_t hz);
+
+/**
+ * @details  Set the duty cycles on P2.6 and P2.7 as fractions of
+ * PWM_FULL, rounded to the nearest step of the period.
+ * @param    duty3 duty on P2.6, 0 to PWM_FULL
+ * @param    duty4 duty on P2.7, 0 to PWM_FULL
+ * @return   none
+ * @note     Assumes PWM_InitHz() has been called
+ * @brief    set both duty cycles
+ */
+void PWM_Set34(uint16_t duty3, uint16_t duty4);
+
 #endif
@@ -0,0 +1,192 @@
+// Param.c
+// Runs on MSP432
+// Registry of run-time tunable parameters, with writes
+// staged until the control loop commits them and an
+// optional copy kept in flash.
+
+#include <stdint.h>
+#include <string.h>
+#include "CortexM.h"
+#include "Flash.h"
+#include "Param.h"
+
+#define MAGIC 0x50415231       // "PAR1"
+
+// layout of the record in the FLASH_PARAMS sector
+struct Record {
+  uint32_t Magic;
+  uint32_t Hash;               // hash of the names, detects a changed table
+  uint32_t Count;
+  int32_t Value[PARAM_MAX];
+  uint32_t Check;              // sum of all the words above
+};
+
+static const struct Param *Table;
+static uint8_t Count;
+static int32_t Staged[PARAM_MAX];
+static volatile uint64_t Dirty;    // bit i set when Staged[i] is waiting
+
+// ------------hash------------
+// FNV-1a hash of every name in the table, in order.
+static uint32_t hash(void){
+  uint32_t h = 2166136261u;
+  uint8_t i;
+  const char *pt;
+  for(i = 0; i < Count; i++){
+    for(pt = Table[i].Name; *pt; pt++){
+      h = (h ^ (uint8_t)*pt)*16777619u;
+    }
+    h = (h ^ ' ')*16777619u;
+  }
+  return h;
+}
+
+// ------------checksum------------
+// Sum of every word of a record before Check.
+static uint32_t checksum(const struct Record *r){
+  const uint32_t *pt = (const uint32_t *)r;
+  uint32_t sum = 0;
+  uint32_t i;
+  for(i = 0; i < (sizeof(struct Record)/4 - 1); i++){
+    sum += pt[i];
+  }
+  return sum;
+}
+
+// ------------store------------
+// Write a value into a variable.
+static void store(uint8_t index, int32_t value){
+  if(Table[index].Type == PARAM_U16){
+    *(uint16_t *)Table[index].Addr = (uint16_t)value;
+  }else if(Table[index].Type == PARAM_S16){
+    *(int16_t *)Table[index].Addr = (int16_t)value;
+  }else{
+    *(uint32_t *)Table[index].Addr = (uint32_t)value;
+  }
+}
+
+// ------------Param_Init------------
+// Register the table and restore saved values.
+// Input: table entries
+//        count number of entries
+// Output: 1 if saved values were loaded, 0 if not
+uint8_t Param_Init(const struct Param *table, uint8_t count){
+  const struct Record *saved = (const struct Record *)FLASH_PARAMS;
+  uint8_t i;
+  Table = table;
+  Count = (count > PARAM_MAX) ? PARAM_MAX : count;
+  Dirty = 0;
+  if((saved->Magic != MAGIC) || (saved->Hash != hash()) ||
+     (saved->Count != Count) || (saved->Check != checksum(saved))){
+    return 0;
+  }
+  for(i = 0; i < Count; i++){
+    if((saved->Value[i] < Table[i].Min) || (saved->Value[i] > Table[i].Max)){
+      return 0;
+    }
+  }
+  for(i = 0; i < Count; i++){
+    store(i, saved->Value[i]);
+  }
+  return 1;
+}
+
+// ------------Param_Count------------
+uint8_t Param_Count(void){
+  return Count;
+}
+
+// ------------Param_Entry------------
+const struct Param *Param_Entry(uint8_t index){
+  if(index >= Count){
+    return 0;
+  }
+  return &Table[index];
+}
+
+// ------------Param_Find------------
+// Input: name parameter name
+// Output: index, or -1 if not found
+int16_t Param_Find(const char *name){
+  uint8_t i;
+  for(i = 0; i < Count; i++){
+    if(strcmp(Table[i].Name, name) == 0){
+      return i;
+    }
+  }
+  return -1;
+}
+
+// ------------Param_Get------------
+// Input: index of the parameter
+// Output: current value
+int32_t Param_Get(uint8_t index){
+  if(index >= Count){
+    return 0;
+  }
+  if(Table[index].Type == PARAM_U16){
+    return *(uint16_t *)Table[index].Addr;
+  }
+  if(Table[index].Type == PARAM_S16){
+    return *(int16_t *)Table[index].Addr;
+  }
+  return (int32_t)*(uint32_t *)Table[index].Addr;
+}
+
+// ------------Param_Set------------
+// Stage a value for the next Param_Commit.
+// Input: index of the parameter
+//        value new value
+// Output: 0 if staged, 1 if out of range
+uint8_t Param_Set(uint8_t index, int32_t value){
+  long sr;
+  if((index >= Count) || (value < Table[index].Min) || (value > Table[index].Max)){
+    return 1;
+  }
+  sr = StartCritical();        // Param_Commit may run in between otherwise
+  Staged[index] = value;
+  Dirty |= ((uint64_t)1<<index);
+  EndCritical(sr);
+  return 0;
+}
+
+// ------------Param_Commit------------
+// Apply every staged value.  Runs with interrupts off so
+// a Param_Set that preempts it cannot be half applied.
+void Param_Commit(void){
+  long sr;
+  uint64_t dirty;
+  uint8_t i;
+  if(Dirty == 0){
+    return;
+  }
+  sr = StartCritical();
+  dirty = Dirty;
+  Dirty = 0;
+  for(i = 0; dirty; i++, dirty >>= 1){
+    if(dirty & 1){
+      store(i, Staged[i]);
+    }
+  }
+  EndCritical(sr);
+}
+
+// ------------Param_Save------------
+// Write the current values to the FLASH_PARAMS sector.
+// Output: 0 on success, 1 on failure
+uint8_t Param_Save(void){
+  static struct Record r;
+  uint8_t i;
+  memset(&r, 0, sizeof(r));
+  r.Magic = MAGIC;
+  r.Hash = hash();
+  r.Count = Count;
+  for(i = 0; i < Count; i++){
+    r.Value[i] = Param_Get(i);
+  }
+  r.Check = checksum(&r);
+  if(Flash_Erase(FLASH_PARAMS)){
+    return 1;
+  }
+  return Flash_Write(FLASH_PARAMS, (const uint32_t *)&r, sizeof(r)/4);
+}
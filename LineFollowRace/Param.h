@@ -0,0 +1,118 @@
+#ifndef PARAM_H_
+#define PARAM_H_
+
+/**
+ * @file      Param.h
+ * @brief     Registry of run-time tunable parameters
+ * @details   The application hands Param_Init() a table naming each
+ * variable that may be changed while the robot runs, with its type and
+ * allowed range.  Writes are staged by Param_Set() and only land in the
+ * variables when the control loop calls Param_Commit() between ticks, so
+ * a tick never sees half of an update.  Param_Save() stores the current
+ * values in the FLASH_PARAMS sector, and Param_Init() restores them at
+ * the next reset if the table has not changed since.
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup RSLK_Input_Output
+ * @brief
+ * @{*/
+
+/**
+ * \brief most entries a table may have
+ */
+#define PARAM_MAX 64
+
+/**
+ * \brief variable is a uint16_t
+ */
+#define PARAM_U16 0
+/**
+ * \brief variable is a uint32_t
+ */
+#define PARAM_U32 1
+/**
+ * \brief variable is an int16_t
+ */
+#define PARAM_S16 2
+
+/**
+ * One tunable variable
+ */
+struct Param {
+  const char *Name;   // name used by the shell, no spaces
+  void *Addr;         // the variable
+  uint8_t Type;       // PARAM_U16, PARAM_U32 or PARAM_S16
+  int32_t Min;        // smallest allowed value
+  int32_t Max;        // largest allowed value
+};
+
+/**
+ * Register the table and load any values saved by Param_Save().
+ * Saved values are ignored if the table's names have changed or
+ * a value is out of range.
+ * @param  table entries, must stay valid while the program runs
+ * @param  count number of entries, at most PARAM_MAX
+ * @return 1 if saved values were loaded, 0 if the defaults were kept
+ * @brief  Initialize the parameter registry
+ */
+uint8_t Param_Init(const struct Param *table, uint8_t count);
+
+/**
+ * @param  none
+ * @return number of entries in the table
+ * @brief  Number of parameters
+ */
+uint8_t Param_Count(void);
+
+/**
+ * @param  index 0 to Param_Count()-1
+ * @return the entry, or 0 if index is out of range
+ * @brief  Look up a parameter by index
+ */
+const struct Param *Param_Entry(uint8_t index);
+
+/**
+ * @param  name parameter name
+ * @return index of the parameter, or -1 if there is none by that name
+ * @brief  Look up a parameter by name
+ */
+int16_t Param_Find(const char *name);
+
+/**
+ * @param  index 0 to Param_Count()-1
+ * @return current value of the variable
+ * @brief  Read a parameter
+ */
+int32_t Param_Get(uint8_t index);
+
+/**
+ * Stage a new value.  It takes effect at the next Param_Commit().
+ * @param  index 0 to Param_Count()-1
+ * @param  value new value
+ * @return 0 if staged, 1 if index or value is out of range
+ * @brief  Write a parameter
+ */
+uint8_t Param_Set(uint8_t index, int32_t value);
+
+/**
+ * Copy every staged value into its variable.  Call from the
+ * control loop between ticks.
+ * @param  none
+ * @return none
+ * @brief  Apply staged parameter writes
+ */
+void Param_Commit(void);
+
+/**
+ * Write the current values to flash.
+ * @param  none
+ * @return 0 on success, 1 if the flash write failed
+ * @note   Blocks for a sector erase; do it with the robot parked
+ * @brief  Save parameters to flash
+ */
+uint8_t Param_Save(void);
+
+#endif /* PARAM_H_ */
@@ -0,0 +1,95 @@
+// Rate.c
+// Runs on MSP432
+// Chooses each control period from the commanded speed and
+// how fast the line is moving across the sensor bar.
+
+#include <stdint.h>
+#include "Reflectance.h"
+#include "Rate.h"
+
+static struct Rate_Stats Stats;
+static uint32_t MinUs, MaxUs;    // bounds
+static uint32_t TravelUm, SlewUm;
+static int32_t Last;             // previous position, REFLECTANCE_NOLINE if none
+
+// ------------Rate_Init------------
+void Rate_Init(uint32_t us){
+  Stats.Us = us;
+  Stats.Speed = Stats.Slew = 0;
+  Stats.MinUs = 0xFFFFFFFF;
+  Stats.MaxUs = 0;
+  Stats.Steps = Stats.TotalUs = 0;
+  Last = REFLECTANCE_NOLINE;
+  MinUs = MaxUs = us;
+}
+
+// ------------Rate_Set------------
+void Rate_Set(uint32_t min_us, uint32_t max_us, uint32_t travel_um, uint32_t slew_um){
+  MinUs = min_us;
+  MaxUs = (max_us > min_us) ? max_us : min_us;
+  TravelUm = travel_um;
+  SlewUm = slew_um;
+}
+
+// ------------Rate_Step------------
+// Input: us period since the last step
+//        speed commanded speed, mm/s
+//        position line position, um
+// Output: us until the next step
+uint32_t Rate_Step(uint32_t us, uint32_t speed, int32_t position){
+  uint32_t target = MaxUs;
+  uint32_t slew, t;
+  Stats.Speed = speed;
+  if(position == REFLECTANCE_NOLINE){
+    target = MinUs;              // lost: look often
+  }else if(Last != REFLECTANCE_NOLINE){
+    // um per us is m/s, so times 1000 is mm/s
+    slew = ((position > Last) ? position - Last : Last - position)*1000/us;
+    if(slew > Stats.Slew){
+      Stats.Slew += (slew - Stats.Slew + 3)>>2;
+    }else{
+      Stats.Slew -= (Stats.Slew - slew)>>2;
+    }
+  }
+  Last = position;
+  if(speed){                     // um over mm/s is ms, times 1000 is us
+    t = TravelUm*1000/speed;
+    if(t < target){
+      target = t;
+    }
+  }
+  if(Stats.Slew){
+    t = SlewUm*1000/Stats.Slew;
+    if(t < target){
+      target = t;
+    }
+  }
+  if(target > us + RATE_UP_US){
+    target = us + RATE_UP_US;
+  }
+  if(target > MaxUs){
+    target = MaxUs;
+  }
+  if(target < MinUs){
+    target = MinUs;
+  }
+  target -= target%RATE_TICK_US; // whole ticks, rounded toward faster
+  if(target < RATE_TICK_US){
+    target = RATE_TICK_US;
+  }
+  Stats.Us = target;
+  Stats.Steps++;
+  Stats.TotalUs += target;
+  if(target < Stats.MinUs){
+    Stats.MinUs = target;
+  }
+  if(target > Stats.MaxUs){
+    Stats.MaxUs = target;
+  }
+  return target;
+}
+
+// ------------Rate_GetStats------------
+const struct Rate_Stats *Rate_GetStats(void){
+  return &Stats;
+}
@@ -0,0 +1,94 @@
+#ifndef RATE_H_
+#define RATE_H_
+
+/**
+ * @file      Rate.h
+ * @brief     Control period governed by speed and how fast the line moves
+ * @details   A fixed period is too long at full duty, where the robot
+ * covers most of a sensor pitch (9.5 mm) between readings, and wastes
+ * steps when it is slow.  Rate_Step() is called once per control step
+ * with the commanded speed and the line position, and returns the
+ * period to sleep before the next step.<br>
+ * Two periods are worked out and the shorter is used: the time to
+ * travel a set distance at the commanded speed, and the time for the
+ * line to move a set distance across the sensor bar at its recent
+ * speed (the change in position per step, filtered over about four
+ * steps).  With the line lost the period is the shortest, so the
+ * search sees it again as soon as possible.  The result is kept
+ * between the bounds and cut to whole kernel ticks (ms).  A shorter
+ * period takes effect at once; a longer one grows by at most
+ * RATE_UP_US per step, so one quiet reading cannot slow the loop down.
+ * tools/ratestudy.py runs the same rule in a simulation to choose the
+ * distances.
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup MSP432
+ * @brief
+ * @{*/
+
+/**
+ * \brief most the period grows per step, us
+ */
+#define RATE_UP_US 1000
+/**
+ * \brief speed at full duty when there is no motor table, mm/s
+ */
+#define RATE_TOP_MM_S 500
+/**
+ * \brief kernel tick, the period is a whole number of these, us
+ */
+#define RATE_TICK_US 1000
+
+/**
+ * What the governor is doing
+ */
+struct Rate_Stats {
+  uint32_t Us;         // period chosen last
+  uint32_t Speed;      // commanded speed, mm/s
+  uint32_t Slew;       // line speed across the sensor bar, mm/s, filtered
+  uint32_t MinUs;      // shortest period used since Rate_Init()
+  uint32_t MaxUs;      // longest
+  uint32_t Steps;      // Rate_Step() calls
+  uint32_t TotalUs;    // sum of the periods returned, for the mean
+};
+
+/**
+ * Start the governor.
+ * @param  us period to start with
+ * @return none
+ * @brief  Initialize the rate governor
+ */
+void Rate_Init(uint32_t us);
+
+/**
+ * Set the bounds and distances.  Cheap, may be called every step.
+ * @param  min_us shortest period
+ * @param  max_us longest period
+ * @param  travel_um most the robot should move in one period
+ * @param  slew_um most the line should move across the bar in one period
+ * @return none
+ * @brief  Configure the rate governor
+ */
+void Rate_Set(uint32_t min_us, uint32_t max_us, uint32_t travel_um, uint32_t slew_um);
+
+/**
+ * Choose the period until the next step.
+ * @param  us period since the last step, governed or not
+ * @param  speed commanded speed in mm/s
+ * @param  position line position from Reflectance_Position(), um
+ * @return period in us, a whole number of ms
+ * @brief  Govern one step
+ */
+uint32_t Rate_Step(uint32_t us, uint32_t speed, int32_t position);
+
+/**
+ * @param  none
+ * @return the period in use and what it was chosen from
+ * @brief  Governor state
+ */
+const struct Rate_Stats *Rate_GetStats(void);
+
+#endif /* RATE_H_ */
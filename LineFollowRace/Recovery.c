@@ -0,0 +1,110 @@
+// Recovery.c
+// Runs on MSP432
+// Lost-line search for the line follower.  While the FSM is in
+// the Error state the robot pivots toward the side the line was
+// last seen on, turning faster at each spin level, then falls
+// back to a widening spiral if the line still has not come back.
+
+#include <stdint.h>
+#include "Motor.h"
+#include "Recovery.h"
+
+// pivot duty for each spin level, slowest first
+static const uint16_t SpinDuty[] = {1500, 2500, 3500};
+#define SPIN_LEVELS (sizeof(SpinDuty)/sizeof(SpinDuty[0]))
+
+#define SPIRAL_OUTER     3000  // duty of the outer wheel during the spiral
+#define SPIRAL_INNER_MAX 2600  // inner wheel stops speeding up here
+#define SPIRAL_STEP        25  // inner wheel duty added each tick
+
+static uint8_t LastSide;       // RECOVERY_LEFT or RECOVERY_RIGHT, where the line was last seen
+static uint8_t Searching;      // 1 while a search is running
+static uint32_t Ticks;         // ticks since the search started
+static uint16_t Inner;         // inner wheel duty during the spiral
+static struct Recovery_Stats Stats;
+
+// ------------Recovery_Init------------
+// Clear the remembered side and the statistics.
+// Input: none
+// Output: none
+void Recovery_Init(void){
+  LastSide = RECOVERY_NONE;
+  Searching = 0;
+  Ticks = 0;
+  Stats.Searches = 0;
+  Stats.Spirals = 0;
+  Stats.Last = 0;
+  Stats.Min = 0xFFFFFFFF;
+  Stats.Max = 0;
+  Stats.Total = 0;
+}
+
+// ------------Recovery_LineSeen------------
+// Remember the side the line is on and end any search.
+// Input: side RECOVERY_LEFT, RECOVERY_RIGHT, or RECOVERY_NONE
+//        to keep the previous side (line under the center)
+// Output: none
+void Recovery_LineSeen(uint8_t side){
+  if(side != RECOVERY_NONE){
+    LastSide = side;
+  }
+  if(Searching){
+    Searching = 0;
+    Stats.Last = Ticks;
+    Stats.Total += Ticks;
+    if(Ticks < Stats.Min) Stats.Min = Ticks;
+    if(Ticks > Stats.Max) Stats.Max = Ticks;
+  }
+}
+
+// ------------Recovery_Step------------
+// Run one tick of the search, starting one if needed.
+// Spin phase: counter-rotate toward LastSide, one level
+//   every RECOVERY_SPIN_TICKS ticks
+// Spiral phase: outer wheel at SPIRAL_OUTER, inner wheel
+//   speeding up so the turn radius keeps growing
+// With no remembered side there is nothing to spin toward,
+// so the search goes straight to a right-hand spiral.
+// Input: none
+// Output: none
+void Recovery_Step(void){
+  uint32_t level;
+
+  if(!Searching){
+    Searching = 1;
+    Ticks = 0;
+    Inner = 0;
+    Stats.Searches++;
+  }
+  Ticks++;
+
+  level = (Ticks - 1)/RECOVERY_SPIN_TICKS;
+  if((LastSide != RECOVERY_NONE) && (level < SPIN_LEVELS)){
+    if(LastSide == RECOVERY_RIGHT){
+      Motor_Right(SpinDuty[level], SpinDuty[level]);
+    }else{
+      Motor_Left(SpinDuty[level], SpinDuty[level]);
+    }
+    return;
+  }
+
+  if(Inner == 0){
+    Stats.Spirals++;           // first spiral tick of this search
+  }
+  if(Inner < SPIRAL_INNER_MAX){
+    Inner += SPIRAL_STEP;
+  }
+  if(LastSide == RECOVERY_LEFT){
+    Motor_Forward(Inner, SPIRAL_OUTER);
+  }else{
+    Motor_Forward(SPIRAL_OUTER, Inner);
+  }
+}
+
+// ------------Recovery_GetStats------------
+// Return the time-to-reacquire statistics.
+// Input: none
+// Output: pointer to the statistics
+const struct Recovery_Stats *Recovery_GetStats(void){
+  return &Stats;
+}
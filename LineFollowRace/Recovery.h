@@ -0,0 +1,95 @@
+#ifndef RECOVERY_H_
+#define RECOVERY_H_
+
+/**
+ * @file      Recovery.h
+ * @brief     Lost-line search used while the FSM is in the Error state
+ * @details   The search remembers which side of the robot the line was
+ * last seen on and pivots toward it, stepping the turn rate up every
+ * RECOVERY_SPIN_TICKS control ticks.  If the line has not come back
+ * once every spin level has been tried, the search falls back to a
+ * spiral in the same direction whose radius widens each tick.<br>
+ * All times are in control ticks (one pass of the main loop).
+<table>
+<caption id="Recovery_phases">Search phases</caption>
+<tr><th>Phase  <th>Wheels                          <th>Ends
+<tr><td>Spin   <td>counter-rotate toward last side <td>line seen, or all spin levels used
+<tr><td>Spiral <td>outer wheel fixed, inner speeds up <td>line seen
+</table>
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup RSLK_Input_Output
+ * @brief
+ * @{*/
+
+/**
+ * \brief side of the robot the line was last seen on is unknown
+ */
+#define RECOVERY_NONE   0
+/**
+ * \brief line was last seen off the robot's left edge (Right1-3 states)
+ */
+#define RECOVERY_LEFT   1
+/**
+ * \brief line was last seen off the robot's right edge (Left1-3 states)
+ */
+#define RECOVERY_RIGHT  2
+
+/**
+ * \brief number of control ticks spent at each spin level
+ */
+#define RECOVERY_SPIN_TICKS 8
+
+/**
+ * Time-to-reacquire statistics, in control ticks
+ */
+struct Recovery_Stats {
+  uint32_t Searches;   // number of times the line was lost
+  uint32_t Spirals;    // searches that timed out into the spiral
+  uint32_t Last;       // ticks the most recent search took
+  uint32_t Min;        // shortest search
+  uint32_t Max;        // longest search
+  uint32_t Total;      // sum of all searches, Total/Searches is the mean
+};
+
+/**
+ * Clear the remembered side and the statistics
+ * @param  none
+ * @return none
+ * @brief  Initialize the lost-line search
+ */
+void Recovery_Init(void);
+
+/**
+ * Call once per control tick while the line is visible.
+ * Remembers the side the line is on and, if a search was
+ * running, ends it and records how long it took.
+ * @param  side RECOVERY_LEFT, RECOVERY_RIGHT, or RECOVERY_NONE to keep the previous side
+ * @return none
+ * @brief  Report that the line is visible
+ */
+void Recovery_LineSeen(uint8_t side);
+
+/**
+ * Call once per control tick while the line is lost.
+ * Starts a search on the first call and drives the
+ * motors for the current phase.
+ * @param  none
+ * @return none
+ * @note   Assumes Motor_Init() has been called
+ * @brief  Run one tick of the lost-line search
+ */
+void Recovery_Step(void);
+
+/**
+ * Return the time-to-reacquire statistics
+ * @param  none
+ * @return pointer to the statistics, valid until the next Recovery_Init()
+ * @brief  Get lost-line search statistics
+ */
+const struct Recovery_Stats *Recovery_GetStats(void);
+
+#endif /* RECOVERY_H_ */
@@ -22,8 +22,61 @@
 #include <stdint.h>
 #include "msp432.h"
 #include "Clock.h"
+#include "CortexM.h"
 #include "Reflectance.h"
 
+#define EVEN REFLECTANCE_EVEN   // sensors 2,4,6,8 (P7.1,3,5,7), lit by the even LEDs on P5.3
+#define ODD  REFLECTANCE_ODD    // sensors 1,3,5,7 (P7.0,2,4,6), lit by the odd LEDs on P9.2
+
+static struct Reflectance_Stats Stats;
+static uint32_t LitAt[2];   // cycle count when the even, odd LEDs were turned on
+static uint32_t OnUs;       // LED bank on-time since the last reading was counted
+
+// ------------emitters------------
+// Turn LED banks on or off, adding up how long each was lit.
+// Input: banks EVEN, ODD or both
+//        on 1 to turn them on, 0 to turn them off
+static void emitters(uint8_t banks, uint8_t on){
+    uint32_t now = CycleCounter_Read();
+    if(banks & EVEN){
+        if(on){
+            P5->OUT |= 0x08;
+            LitAt[0] = now;
+        }else if(P5->OUT & 0x08){
+            P5->OUT &= ~0x08;
+            OnUs += (now - LitAt[0])/48;   // 48 MHz core clock
+        }
+    }
+    if(banks & ODD){
+        if(on){
+            P9->OUT |= 0x04;
+            LitAt[1] = now;
+        }else if(P9->OUT & 0x04){
+            P9->OUT &= ~0x04;
+            OnUs += (now - LitAt[1])/48;
+        }
+    }
+}
+
+// ------------Reflectance_Tally------------
+// Count a reading for the all-on vs staggered comparison.
+// A line under the array reads as one run of ones; two or
+// more separate runs cannot be a single line and are
+// counted as a misread.  The LED on-time since the last
+// reading was counted is booked to this one.
+// Input: mode REFLECTANCE_ALLON, REFLECTANCE_STAGGERED or REFLECTANCE_LEVELS
+//        data 8-bit reading
+// Output: none
+void Reflectance_Tally(uint8_t mode, uint8_t data){
+    uint8_t starts = data & ~(data << 1);   // one bit at the start of each run
+    Stats.Reads[mode]++;
+    if(starts & (starts - 1)){
+        Stats.Misreads[mode]++;
+    }
+    Stats.EmitterUs[mode] += OnUs;
+    OnUs = 0;
+}
+
 // ------------Reflectance_Init------------
 // Initialize the GPIO pins associated with the QTR-8RC
 // reflectance sensor.  Infrared illumination LEDs are
@@ -66,9 +119,8 @@ uint8_t Reflectance_Read(uint32_t time){
     // Create the result variable
     uint8_t result;
 
-    // Turn on the 8 IR LEDs
-    P5->OUT |= 0x08; // Turn even sensor LEDs (P5.3) on
-    P9->OUT |= 0x04; // Turn odd sensor LEDs (P9.2) on
+    // Turn on the 8 IR LEDs, even (P5.3) and odd (P9.2)
+    emitters(EVEN|ODD, 1);
 
     // Pulse 8 sensors high for 10 us
     P7->DIR |= 0xFF; // Switch 8 sensors to outputs
@@ -86,13 +138,46 @@ uint8_t Reflectance_Read(uint32_t time){
     result = P7->IN;
 
     // Turn off the 8 IR LEDs
-    P5->OUT &= ~0x08; // Turn even sensor LEDs (P5.3) off
-    P9->OUT &= ~0x04; // Turn odd sensor LEDs (P9.2) off
+    emitters(EVEN|ODD, 0);
+
+    Reflectance_Tally(REFLECTANCE_ALLON, result);
 
     // Return the result
     return result;
 }
 
+// ------------Reflectance_ReadStaggered------------
+// Read the even bank and then the odd bank, one after the
+// other.  Each bank's LEDs are off again before the other
+// bank is lit, so no sensor decays under its neighbours'
+// emitters.  The call takes twice as long as Reflectance_Read;
+// Sample.c runs the two banks between control steps instead.
+// Input: time to wait in usec
+// Output: sensor readings
+// Assumes: Reflectance_Init() has been called
+uint8_t Reflectance_ReadStaggered(uint32_t time){
+    uint8_t result;
+
+    Reflectance_StartBank(EVEN);
+    Clock_Delay1us(time);
+    result = Reflectance_EndBank(EVEN);
+
+    Reflectance_StartBank(ODD);
+    Clock_Delay1us(time);
+    result |= Reflectance_EndBank(ODD);
+
+    Reflectance_Tally(REFLECTANCE_STAGGERED, result);
+    return result;
+}
+
+// ------------Reflectance_GetStats------------
+// Return the misread and emitter on-time counters.
+// Input: none
+// Output: pointer to the counters
+const struct Reflectance_Stats *Reflectance_GetStats(void){
+    return &Stats;
+}
+
 // ------------Reflectance_Center------------
 // Read the two center sensors
 // Turn on the 8 IR LEDs
@@ -121,13 +206,200 @@ uint8_t Reflectance_Center(uint32_t time){
 }
 
 
-// Perform sensor integration
+// ------------Reflectance_ReadLevels------------
+// Read a grey level for each of the eight sensors from one
+// charge/discharge cycle.  P7->IN is sampled at each of the
+// k delays; a sensor's level is the number of samples in which
+// it was still high.  Because the pins only decay, the samples
+// form a thermometer code and the level is 0 (white, decayed
+// before the first delay) to k (black, still high at the last).
+// Timer_A1 runs free at 1 MHz so the delays are measured from
+// the end of the charge pulse rather than accumulated.
+// Timer_A1 is also the ReflectanceDMA sample clock, so the
+// caller makes sure no capture is running.
+// Input: delays sample times in usec after the charge pulse, ascending
+//        k number of delays, 1 to REFLECTANCE_MAX_LEVELS
+//        levels 8-element array for the result, index 0 is P7.0
+// Output: sensor readings at the middle delay, delays[k/2]
+// Assumes: Reflectance_Init() has been called
+uint8_t Reflectance_ReadLevels(const uint16_t *delays, uint8_t k, uint8_t levels[8]){
+    uint8_t snap[REFLECTANCE_MAX_LEVELS];
+    uint8_t i, j;
+
+    if(k > REFLECTANCE_MAX_LEVELS) k = REFLECTANCE_MAX_LEVELS;
+    if(k == 0) k = 1;
+
+    // Timer_A1 free running: SMCLK 12 MHz /4 /3 = 1 MHz
+    TIMER_A1->CTL = 0x0000;      // stop while configuring
+    TIMER_A1->EX0 = 0x0002;      // divide by 3
+    // bits9-8=10, TASSEL SMCLK; bits7-6=10, ID /4; bits5-4=10, continuous mode
+
+    // Turn on the 8 IR LEDs
+    emitters(EVEN|ODD, 1);
+
+    // Pulse 8 sensors high for 10 us
+    P7->DIR = 0xFF;
+    P7->OUT = 0xFF;
+    Clock_Delay1us(10);
+
+    // Switch the sensor pins to input and start timing the decay
+    P7->DIR = 0x00;
+    TIMER_A1->CTL = 0x02A4;      // bit2=1 clears TA1R as the timer starts
+
+    for(j = 0; j < k; j++){
+        while(TIMER_A1->R < delays[j]){};
+        snap[j] = P7->IN;
+    }
+
+    // Turn off the 8 IR LEDs
+    emitters(EVEN|ODD, 0);
+    TIMER_A1->CTL = 0x0000;
+    Reflectance_Tally(REFLECTANCE_LEVELS, snap[k/2]);
+
+    // Count the ones in each bit position
+    for(i = 0; i < 8; i++){
+        uint8_t level = 0;
+        for(j = 0; j < k; j++){
+            level += (snap[j] >> i) & 0x01;
+        }
+        levels[i] = level;
+    }
+    return snap[k/2];
+}
+
+// ------------Reflectance_ReadDecay------------
+// Time how long each sensor stays high after the charge
+// pulse.  P7->IN is polled with Timer_A1 running free at
+// 1 MHz, as in Reflectance_ReadLevels, and the poll ends
+// when every pin has fallen or max us have passed.  As
+// there, no ReflectanceDMA capture may be running.
+// Input: max longest time to wait in usec, below 65536
+//        decay 8-element array for the result in usec, index 0 is P7.0
+// Output: sensors still high at max, 1 is black
+// Assumes: Reflectance_Init() has been called
+uint8_t Reflectance_ReadDecay(uint32_t max, uint16_t decay[8]){
+    uint8_t high = 0xFF;        // pins not yet fallen
+    uint8_t fell;
+    uint16_t t;
+    uint8_t i;
+
+    for(i = 0; i < 8; i++){
+        decay[i] = max;
+    }
+    TIMER_A1->CTL = 0x0000;
+    TIMER_A1->EX0 = 0x0002;      // divide by 3, SMCLK 12 MHz /4 /3 = 1 MHz
+
+    // Turn on the 8 IR LEDs and pulse the 8 sensors high for 10 us
+    P5->OUT |= 0x08;
+    P9->OUT |= 0x04;
+    P7->DIR = 0xFF;
+    P7->OUT = 0xFF;
+    Clock_Delay1us(10);
+
+    P7->DIR = 0x00;
+    TIMER_A1->CTL = 0x02A4;      // continuous, cleared as it starts
+    do{
+        t = TIMER_A1->R;
+        fell = high & ~P7->IN;
+        if(fell){
+            for(i = 0; i < 8; i++){
+                if((fell >> i) & 0x01){
+                    decay[i] = t;
+                }
+            }
+            high &= ~fell;
+        }
+    }while(high && (t < max));
+
+    // Turn off the 8 IR LEDs
+    P5->OUT &= ~0x08;
+    P9->OUT &= ~0x04;
+    TIMER_A1->CTL = 0x0000;
+    return high;
+}
+
+
+// sensor weights in um, bit 0 (robot's right) to bit 7 (robot's left)
+#define W0 -33400
+#define W1 -23800
+#define W2 -14300
+#define W3  -4800
+#define W4   4800
+#define W5  14300
+#define W6  23800
+#define W7  33400
+
+// The position tables below are filled in by the compiler from
+// W0-W7, so changing a weight above updates every variant.
+#define BIT(d,i)   (((d)>>(i))&1)
+#define LOSUM(d)   (BIT(d,0)*W0 + BIT(d,1)*W1 + BIT(d,2)*W2 + BIT(d,3)*W3)
+#define HISUM(d)   (BIT(d,0)*W4 + BIT(d,1)*W5 + BIT(d,2)*W6 + BIT(d,3)*W7)
+#define COUNT(d)   (BIT(d,0)+BIT(d,1)+BIT(d,2)+BIT(d,3)+BIT(d,4)+BIT(d,5)+BIT(d,6)+BIT(d,7))
+#define POS(d)     ((d) ? (LOSUM((d)&0x0F) + HISUM((d)>>4))/(COUNT(d) + !(d)) : REFLECTANCE_NOLINE)
+#define POS4(d)    POS(d), POS((d)+1), POS((d)+2), POS((d)+3)
+#define POS16(d)   POS4(d), POS4((d)+4), POS4((d)+8), POS4((d)+12)
+#define LO4(d)     LOSUM(d), LOSUM((d)+1), LOSUM((d)+2), LOSUM((d)+3)
+#define HI4(d)     HISUM(d), HISUM((d)+1), HISUM((d)+2), HISUM((d)+3)
+
+// position for every 8-bit sensor reading
+static const int32_t PositionTable[256] = {
+  POS16(0x00), POS16(0x10), POS16(0x20), POS16(0x30),
+  POS16(0x40), POS16(0x50), POS16(0x60), POS16(0x70),
+  POS16(0x80), POS16(0x90), POS16(0xA0), POS16(0xB0),
+  POS16(0xC0), POS16(0xD0), POS16(0xE0), POS16(0xF0)
+};
+
+// weight sums of the low (bits 3-0) and high (bits 7-4) nibbles
+static const int32_t LowSum[16]  = {LO4(0), LO4(4), LO4(8), LO4(12)};
+static const int32_t HighSum[16] = {HI4(0), HI4(4), HI4(8), HI4(12)};
+
+// Recip[n] = ceil(2^24/n); (a*Recip[n])>>24 equals a/n exactly
+// for the a < 2^17 that four weights can add up to
+static const uint32_t Recip[9] = {
+  0, 16777216, 8388608, 5592406, 4194304, 3355444, 2796203, 2396746, 2097152
+};
+
+// ------------Reflectance_Position------------
+// Perform sensor integration with a table lookup.
 // Input: data is 8-bit result from line sensor
-// Output: position in um relative to center of line
+// Output: position in um relative to center of line,
+//         REFLECTANCE_NOLINE if data is zero
 int32_t Reflectance_Position(uint8_t data){
+  return PositionTable[data];
+}
+
+// ------------Reflectance_PositionPopcount------------
+// Perform sensor integration without the 256-entry table
+// and without a divide.  The sensor count is a popcount,
+// the weight sum comes from two nibble tables, and the
+// divide is a multiply by a reciprocal.
+// Input: data is 8-bit result from line sensor
+// Output: same as Reflectance_Position
+int32_t Reflectance_PositionPopcount(uint8_t data){
+  uint32_t n = data - ((data >> 1) & 0x55);  // 2-bit counts
+  n = (n & 0x33) + ((n >> 2) & 0x33);        // 4-bit counts
+  n = (n + (n >> 4)) & 0x0F;                 // number of sensors on the line
+
+  int32_t num = LowSum[data & 0x0F] + HighSum[data >> 4];
+  int32_t sign = num >> 31;                  // 0 or -1
+  uint32_t mag = (uint32_t)((num ^ sign) - sign);
+  int32_t distance = (int32_t)(((uint64_t)mag*Recip[n]) >> 24);
+  distance = (distance ^ sign) - sign;       // divide truncates toward zero
+
+  int32_t none = ((int32_t)n - 1) >> 31;     // -1 if no sensor sees the line
+  return (distance & ~none) | (REFLECTANCE_NOLINE & none);
+}
+
+// ------------Reflectance_PositionRef------------
+// Perform sensor integration with the original weighted
+// average loop.  Kept as the reference the other variants
+// are checked against.
+// Input: data is 8-bit result from line sensor
+// Output: same as Reflectance_Position
+int32_t Reflectance_PositionRef(uint8_t data){
 
     // Set the weights of each sensor
-    int32_t weights[8] = {-33400, -23800, -14300, -4800, 4800, 14300, 23800, 33400};
+    int32_t weights[8] = {W0, W1, W2, W3, W4, W5, W6, W7};
 
     // Calculate the weighted average of the binary sensor states
     int32_t num = 0; // Calculate the numerator
@@ -139,6 +411,9 @@ int32_t Reflectance_Position(uint8_t data){
     for (i=0;i<8;i++) {
         den += ((data >> i) & 0x01);
     }
+    if(den == 0){
+        return REFLECTANCE_NOLINE; // off the line
+    }
 
     // Calculate the distance from the center line
     int32_t distance = num / den;
@@ -147,6 +422,29 @@ int32_t Reflectance_Position(uint8_t data){
 }
 
 
+// ------------Reflectance_PositionLevels------------
+// Perform sensor integration on grey levels.  Each weight
+// counts in proportion to its sensor's level, so a sensor
+// half over the line edge pulls the result half as far.
+// Input: levels 8 grey levels from Reflectance_ReadLevels
+// Output: position in um relative to center of line,
+//         REFLECTANCE_NOLINE if every level is zero
+int32_t Reflectance_PositionLevels(const uint8_t levels[8]){
+    static const int32_t weights[8] = {W0, W1, W2, W3, W4, W5, W6, W7};
+    int32_t num = 0;
+    int32_t den = 0;
+    int i;
+    for(i = 0; i < 8; i++){
+        num += weights[i]*levels[i];
+        den += levels[i];
+    }
+    if(den == 0){
+        return REFLECTANCE_NOLINE;
+    }
+    return num/den;
+}
+
+
 // ------------Reflectance_Start------------
 // Begin the process of reading the eight sensors
 // Turn on the 8 IR LEDs
@@ -156,7 +454,11 @@ int32_t Reflectance_Position(uint8_t data){
 // Output: none
 // Assumes: Reflectance_Init() has been called
 void Reflectance_Start(void){
-    // write this as part of Lab 10
+    emitters(EVEN|ODD, 1);  // Turn the 8 IR LEDs on
+    P7->DIR = 0xFF;  // Switch 8 sensors to outputs
+    P7->OUT = 0xFF;  // Send sensors high
+    Clock_Delay1us(10);
+    P7->DIR = 0x00;  // Switch the sensor pins to input, the decay starts
 }
 
 
@@ -167,10 +469,39 @@ void Reflectance_Start(void){
 // Input: none
 // Output: sensor readings
 // Assumes: Reflectance_Init() has been called
-// Assumes: Reflectance_Start() was called 1 ms ago
+// Assumes: Reflectance_Start() was called the wait time ago
 uint8_t Reflectance_End(void){
-    // write this as part of Lab 10
- return 0; // replace this line
+    uint8_t data = P7->IN;  // 1 is black, still charged
+    emitters(EVEN|ODD, 0);  // Turn off the 8 IR LEDs
+    return data;
+}
+
+// ------------Reflectance_StartBank------------
+// Begin reading one bank of four sensors
+// Pulse the bank's sensors high for 10 us
+// Make them input and turn on the bank's IR LEDs
+// Input: bank REFLECTANCE_EVEN or REFLECTANCE_ODD
+// Output: none
+// Assumes: Reflectance_Init() has been called
+void Reflectance_StartBank(uint8_t bank){
+    P7->OUT |= bank;  // Send the bank's sensors high
+    P7->DIR = bank;   // and only those as outputs
+    Clock_Delay1us(10);
+    P7->DIR = 0x00;   // the decay starts
+    emitters(bank, 1);
+}
+
+// ------------Reflectance_EndBank------------
+// Finish reading one bank of four sensors
+// Read the bank's sensors
+// Turn off the bank's IR LEDs
+// Input: bank REFLECTANCE_EVEN or REFLECTANCE_ODD
+// Output: the bank's bits of the reading, the others 0
+// Assumes: Reflectance_StartBank(bank) was called the wait time ago
+uint8_t Reflectance_EndBank(uint8_t bank){
+    uint8_t data = P7->IN & bank;
+    emitters(bank, 0);
+    return data;
 }
 
 
@@ -106,6 +106,78 @@ void Reflectance_Init(void);
  */
 uint8_t Reflectance_Read(uint32_t time);
 
+/**
+ * \brief all 8 IR LEDs lit for every read, Reflectance_Read()
+ */
+#define REFLECTANCE_ALLON      0
+/**
+ * \brief even and odd banks read one after the other, Reflectance_ReadStaggered()
+ */
+#define REFLECTANCE_STAGGERED  1
+/**
+ * \brief grey levels from one charge, Reflectance_ReadLevels()
+ */
+#define REFLECTANCE_LEVELS     2
+/**
+ * \brief P7 bits of sensors 2,4,6,8, lit by the even LEDs on P5.3
+ */
+#define REFLECTANCE_EVEN       0xAA
+/**
+ * \brief P7 bits of sensors 1,3,5,7, lit by the odd LEDs on P9.2
+ */
+#define REFLECTANCE_ODD        0x55
+
+/**
+ * Counters for comparing the acquisition modes, indexed by
+ * REFLECTANCE_ALLON, REFLECTANCE_STAGGERED or REFLECTANCE_LEVELS
+ */
+struct Reflectance_Stats {
+  uint32_t Reads[3];      // readings taken
+  uint32_t Misreads[3];   // readings with more than one separate run of black sensors
+  uint32_t EmitterUs[3];  // LED bank on-time, us, summed over both banks as measured; proportional to emitter energy
+};
+
+/**
+ * <b>Read the eight sensors, the emitter banks staggered</b>:<br>
+  1) Pulse sensors 2,4,6,8 high for 10 us, then turn on the even IR LEDs (P5.3)<br>
+  2) Wait <b>time</b> us, read the even bank and turn its LEDs off<br>
+  3) Pulse sensors 1,3,5,7 high for 10 us, then turn on the odd IR LEDs (P9.2)<br>
+  4) Wait <b>time</b> us, read the odd bank and turn its LEDs off<br>
+ * Only one bank is ever lit, so no sensor decays under its neighbours'
+ * emitters and the LED current peaks at half that of
+ * Reflectance_Read().  Each bank is lit for its wait only, not its
+ * charge pulse.  The call takes twice as long as Reflectance_Read();
+ * Sample_Schedule() runs the two banks between control steps instead.
+ * @param  time delay value in us
+ * @return 8-bit result, 1 is black
+ * @note Assumes Reflectance_Init() has been called
+ * @brief  Read the eight sensors with staggered emitters.
+ */
+uint8_t Reflectance_ReadStaggered(uint32_t time);
+
+/**
+ * Return the reading, misread and emitter on-time counters for
+ * Reflectance_Read(), Reflectance_ReadStaggered() and
+ * Reflectance_ReadLevels(), and for the
+ * readings Sample.c takes with Reflectance_Tally().  Run a lap in
+ * each mode and compare Misreads/Reads and EmitterUs/Reads.
+ * @param  none
+ * @return pointer to the counters
+ * @brief  Acquisition mode statistics.
+ */
+const struct Reflectance_Stats *Reflectance_GetStats(void);
+
+/**
+ * Count a reading taken with Reflectance_Start()/Reflectance_End()
+ * or the bank functions.  The LED on-time since the last reading
+ * was counted is booked to this one.
+ * @param  mode REFLECTANCE_ALLON, REFLECTANCE_STAGGERED or REFLECTANCE_LEVELS
+ * @param  data 8-bit reading
+ * @return none
+ * @brief  Count a reading.
+ */
+void Reflectance_Tally(uint8_t mode, uint8_t data);
+
 /**
  * <b>Read the two center sensors</b>:<br>
   1) Turn on the 8 IR LEDs<br>
@@ -130,27 +202,116 @@ uint8_t Reflectance_Read(uint32_t time);
 uint8_t Reflectance_Center(uint32_t time);
 
 
+/**
+ * \brief most delays Reflectance_ReadLevels() will sample
+ */
+#define REFLECTANCE_MAX_LEVELS 8
+
+/**
+ * <b>Read a grey level for each of the eight sensors</b>:<br>
+  1) Turn on the 8 IR LEDs<br>
+  2) Pulse the 8 sensors high for 10 us<br>
+  3) Make the sensor pins input and start Timer_A1 at 1 MHz<br>
+  4) Sample the sensors at each of the <b>k</b> delays<br>
+  5) Turn off the 8 IR LEDs<br>
+  6) Level of each sensor = number of samples it was high in<br>
+ * With delays of 250, 500, 1000 and 2000 us (k=4) each sensor
+ * reports 0 to 4, log2(5) bits, for the same time a single
+ * Reflectance_Read(2000) would take.  The 8-bit result is the
+ * sample at the middle delay, delays[k/2]: a sensor is black if
+ * its level is over k/2.
+ * @param  delays sample times in us after the charge pulse, ascending, below 65536
+ * @param  k number of delays, 1 to REFLECTANCE_MAX_LEVELS
+ * @param  levels array of 8 results, index 0 is sensor 1 (P7.0)
+ * @return 8-bit result at the middle delay, 1 is black
+ * @note Assumes Reflectance_Init() has been called
+ * @note Uses Timer_A1, which is also the ReflectanceDMA sample
+ *       clock; do not call it while ReflectanceDMA_Done() returns 0
+ * @brief  Read grey levels of the eight sensors.
+ */
+uint8_t Reflectance_ReadLevels(const uint16_t *delays, uint8_t k, uint8_t levels[8]);
+
+/**
+ * <b>Measure the decay time of each of the eight sensors</b>:<br>
+  1) Turn on the 8 IR LEDs<br>
+  2) Pulse the 8 sensors high for 10 us<br>
+  3) Make the sensor pins input and start Timer_A1 at 1 MHz<br>
+  4) Poll until every sensor has fallen or <b>max</b> us have passed<br>
+  5) Turn off the 8 IR LEDs<br>
+ * Takes as long as the slowest sensor, up to max, so it is meant
+ * for occasional calibration reads rather than every sample.
+ * @param  max longest wait in us, below 65536
+ * @param  decay array of 8 results in us, max for a sensor that did not fall
+ * @return sensors still high at max (1 is black)
+ * @note Assumes Reflectance_Init() has been called
+ * @note Uses Timer_A1, which is also the ReflectanceDMA sample
+ *       clock; do not call it while ReflectanceDMA_Done() returns 0
+ * @brief  Time the decay of the eight sensors.
+ */
+uint8_t Reflectance_ReadDecay(uint32_t max, uint16_t decay[8]);
+
+/**
+ * \brief position returned when no sensor sees the line,
+ * just beyond the outermost sensor weight
+ */
+#define REFLECTANCE_NOLINE 33500
+
 /**
  * <b>Calculate the weighted average for each bit</b>:<br>
- * Position varies from -332 (left) to +332 (right), with units of 0.1mm.<br>
+ * Position varies from -33400 (right) to +33400 (left), with units of um.<br>
 <table>
 <caption id="QTR_distance">8 element arrays</caption>
 <tr><th>  <th>bit7<th>bit6<th>bit5<th>bit4<th>bit3<th>bit2<th>bit1<th>bit0
-<tr><td>Weight<td>-332<td>-237<td>-142<td> -47<td>  47<td> 142<td> 237<td> 332
-<tr><td>Mask  <td>0x01<td>0x02<td>0x04<td>0x08<td>0x10<td>0x20<td>0x40<td>0x80
+<tr><td>Weight<td>33400<td>23800<td>14300<td>4800<td>-4800<td>-14300<td>-23800<td>-33400
+<tr><td>Mask  <td>0x80<td>0x40<td>0x20<td>0x10<td>0x08<td>0x04<td>0x02<td>0x01
 </table>
  * count = 0<br>
  * sum = 0<br>
  * for i from 0 to 7 <br>
  * if (data&Mask[i]) then count++ and sum = sum+Weight[i]<br>
- * calculate <b>position</b> = sum/count
+ * calculate <b>position</b> = sum/count<br>
+ * The result for every input is precomputed at build time,
+ * so this is a single table lookup.
  * @param  data is 8-bit result from line sensor
- * @return position in 0.1mm relative to center of line
+ * @return position in um relative to center of line
  * @brief  Perform sensor integration.
- * @note returns 333 if data is zero (off the line)
+ * @note returns REFLECTANCE_NOLINE if data is zero (off the line)
  * */
 int32_t Reflectance_Position(uint8_t data);
 
+/**
+ * Same result as Reflectance_Position() without the 1 kB table:
+ * popcount for the sensor count, two 16-entry nibble tables for
+ * the weight sum, and a reciprocal multiply instead of the divide.
+ * No branches.
+ * @param  data is 8-bit result from line sensor
+ * @return position in um relative to center of line
+ * @brief  Perform sensor integration without the position table.
+ * @note returns REFLECTANCE_NOLINE if data is zero (off the line)
+ * */
+int32_t Reflectance_PositionPopcount(uint8_t data);
+
+/**
+ * Weighted average computed with loops and a 32-bit divide.
+ * This is the reference the faster variants are checked against.
+ * @param  data is 8-bit result from line sensor
+ * @return position in um relative to center of line
+ * @brief  Perform sensor integration, reference version.
+ * @note returns REFLECTANCE_NOLINE if data is zero (off the line)
+ * */
+int32_t Reflectance_PositionRef(uint8_t data);
+
+/**
+ * Weighted average of the grey levels from Reflectance_ReadLevels(),
+ * using the same weights as Reflectance_Position().  A sensor's
+ * weight counts once for each level it reports.
+ * @param  levels 8 grey levels, index 0 is sensor 1 (P7.0)
+ * @return position in um relative to center of line
+ * @brief  Perform sensor integration on grey levels.
+ * @note returns REFLECTANCE_NOLINE if every level is zero (off the line)
+ * */
+int32_t Reflectance_PositionLevels(const uint8_t levels[8]);
+
 /**
  * <b>Begin the process of reading the eight sensors</b>:<br>
   1) Turn on the 8 IR LEDs<br>
@@ -171,11 +332,35 @@ void Reflectance_Start(void);
  * @param  none
  * @return 8-bit result
  * @note Assumes Reflectance_Init() has been called
- * @note Assumes Reflectance_Start() was called 1 ms ago
+ * @note Assumes Reflectance_Start() was called the wait time ago
  * @brief  Read the eight sensors.
  */
 uint8_t Reflectance_End(void);
 
+/**
+ * <b>Begin reading one bank of four sensors</b>:<br>
+  1) Pulse the bank's sensors high for 10 us<br>
+  2) Make them input<br>
+  3) Turn on the bank's IR LEDs<br>
+ * @param  bank REFLECTANCE_EVEN or REFLECTANCE_ODD
+ * @return none
+ * @note Assumes Reflectance_Init() has been called
+ * @note Assumes the other bank's LEDs are off
+ * @brief  Begin reading one bank.
+ */
+void Reflectance_StartBank(uint8_t bank);
+
+/**
+ * <b>Finish reading one bank of four sensors</b>:<br>
+  1) Read the bank's sensors (white is 0, black is 1)<br>
+  2) Turn off the bank's IR LEDs<br>
+ * @param  bank REFLECTANCE_EVEN or REFLECTANCE_ODD
+ * @return the bank's bits of the 8-bit result, the others 0
+ * @note Assumes Reflectance_StartBank(bank) was called the wait time ago
+ * @brief  Read one bank.
+ */
+uint8_t Reflectance_EndBank(uint8_t bank);
+
 /**
  * <b>Return last reading</b>
  * @param  none
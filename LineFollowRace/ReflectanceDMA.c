@@ -0,0 +1,248 @@
+// ReflectanceDMA.c
+// Runs on MSP432
+// Capture the decay profile of the eight QTR-8RC sensors with
+// the DMA controller.  Timer_A1 CCR0 fires every 10 us after the
+// charge pulse and each compare triggers a one-byte DMA transfer
+// from P7->IN into Buffer[], so the CPU does no work between
+// ReflectanceDMA_Start() and ReflectanceDMA_Done().
+// Captures can also be taken with the IR LEDs off; those see
+// only ambient light and are used to take the ambient part
+// out of the lit decay times.
+
+// reflectance even LED illuminate connected to P5.3
+// reflectance odd LED illuminate connected to P9.2
+// reflectance sensors 1-8 connected to P7.0-P7.7
+
+#include <stdint.h>
+#include "msp.h"
+#include "Clock.h"
+#include "CortexM.h"
+#include "ReflectanceDMA.h"
+
+#define CH       2            // DMA channel 2
+#define CH_BIT   (1<<CH)
+#define SRC_TA1CCR0 6         // channel 2 trigger source 6 is TA1CCR0
+
+// One uDMA channel control structure
+struct DMA_Control_Structure {
+  volatile uint32_t SrcEnd;   // address of the last source item
+  volatile uint32_t DstEnd;   // address of the last destination item
+  volatile uint32_t Control;  // transfer settings and count
+  uint32_t Unused;
+};
+
+// primary and alternate structures for all 8 channels,
+// the controller needs the table on a 256-byte boundary
+#pragma DATA_ALIGN(ControlTable, 256)
+static struct DMA_Control_Structure ControlTable[16];
+
+#define FULL (REFLECTANCEDMA_SAMPLES*REFLECTANCEDMA_PERIOD_US)  // never decayed
+
+static uint8_t Buffer[REFLECTANCEDMA_SAMPLES];
+static uint8_t Running;
+static uint8_t Lit;                // 1 if the last capture had the IR LEDs on
+
+static uint16_t Ambient[8];        // decay times with the IR LEDs off, us
+static uint16_t AmbientEvery;      // one dark capture per this many, 0 for never
+static uint16_t SinceDark;         // captures since the last dark one
+static struct ReflectanceDMA_Cost Cost;
+
+// ------------ReflectanceDMA_Init------------
+// Enable the DMA controller and route Timer_A1 CCR0
+// to channel 2.
+// Input: none
+// Output: none
+void ReflectanceDMA_Init(void){
+  int i;
+  DMA_Control->CFG = 0x01;                       // master enable
+  DMA_Control->CTLBASE = (uint32_t)ControlTable;
+  DMA_Channel->CH_SRCCFG[CH] = SRC_TA1CCR0;
+  DMA_Control->ALTCLR = CH_BIT;                  // use the primary structure
+  DMA_Control->USEBURSTCLR = CH_BIT;             // single requests allowed
+  DMA_Control->REQMASKCLR = CH_BIT;              // accept the hardware trigger
+  DMA_Control->PRIOSET = CH_BIT;                 // sampling beats other DMA traffic
+  Running = 0;
+  for(i = 0; i < 8; i++){
+    Ambient[i] = FULL;                           // no ambient light until measured
+  }
+  AmbientEvery = 0;
+  SinceDark = 0;
+}
+
+// ------------ReflectanceDMA_Start------------
+// Charge the sensors and start the timed capture.
+// Input: ir 1 to light the IR LEDs, 0 for an ambient-only capture
+// Output: none
+// Assumes: ReflectanceDMA_Init() has been called
+void ReflectanceDMA_Start(uint8_t ir){
+  // one byte per trigger from a fixed source into the buffer
+  // bits31-30=00, destination increments by one byte
+  // bits29-28=00, destination size byte
+  // bits27-26=11, source does not increment
+  // bits25-24=00, source size byte
+  // bits17-14=0000, rearbitrate after every transfer
+  // bits13-4, number of transfers - 1
+  // bits2-0=001, basic mode
+  ControlTable[CH].SrcEnd = (uint32_t)&P7->IN;
+  ControlTable[CH].DstEnd = (uint32_t)&Buffer[REFLECTANCEDMA_SAMPLES-1];
+  ControlTable[CH].Control = 0x0C000000 | ((REFLECTANCEDMA_SAMPLES-1)<<4) | 0x01;
+  DMA_Control->ENASET = CH_BIT;
+
+  // Timer_A1 up mode, 10 us at SMCLK 12 MHz, no interrupt;
+  // the DMA acknowledge clears CCIFG for the next trigger
+  TIMER_A1->CTL = 0x0000;
+  TIMER_A1->EX0 = 0x0000;
+  TIMER_A1->CCTL[0] = 0x0000;
+  TIMER_A1->CCR[0] = 12*REFLECTANCEDMA_PERIOD_US - 1;
+
+  // Turn on the 8 IR LEDs
+  Lit = ir;
+  if(ir){
+    P5->OUT |= 0x08;
+    P9->OUT |= 0x04;
+  }
+
+  // Pulse 8 sensors high for 10 us
+  P7->DIR = 0xFF;
+  P7->OUT = 0xFF;
+  Clock_Delay1us(10);
+
+  // Switch the sensor pins to input and start sampling
+  P7->DIR = 0x00;
+  // bits9-8=10, TASSEL SMCLK; bits7-6=00, ID /1; bits5-4=01, up mode; bit2=1, clear
+  TIMER_A1->CTL = 0x0214;
+  Running = 1;
+}
+
+// ------------ReflectanceDMA_Done------------
+// Check whether the capture has finished.  The channel
+// enable bit clears itself after the last transfer.
+// Input: none
+// Output: 1 if complete, 0 if still running
+uint8_t ReflectanceDMA_Done(void){
+  if(DMA_Control->ENASET & CH_BIT){
+    return 0;
+  }
+  if(Running){
+    TIMER_A1->CTL = 0x0000;    // stop sampling
+    P5->OUT &= ~0x08;          // Turn off the 8 IR LEDs
+    P9->OUT &= ~0x04;
+    Running = 0;
+  }
+  return 1;
+}
+
+// ------------ReflectanceDMA_Decay------------
+// Count the samples each sensor read high.  Each nibble
+// of a sample is spread into four byte lanes with one
+// multiply, (n*0x00204081)&0x01010101 puts bit i of n at
+// bit 8i, so eight counters are updated with two adds and
+// no per-bit branches.  Counts stay below 256 because
+// REFLECTANCEDMA_SAMPLES is 200.
+// Input: decay 8-element array for decay times in us
+// Output: none
+void ReflectanceDMA_Decay(uint16_t decay[8]){
+  uint32_t lo = 0;             // counts for P7.3-P7.0, one per byte
+  uint32_t hi = 0;             // counts for P7.7-P7.4
+  uint32_t j, i;
+  for(j = 0; j < REFLECTANCEDMA_SAMPLES; j++){
+    uint32_t s = Buffer[j];
+    lo += ((s & 0x0F)*0x00204081) & 0x01010101;
+    hi += ((s >> 4)*0x00204081) & 0x01010101;
+  }
+  for(i = 0; i < 4; i++){
+    decay[i]   = ((lo >> (8*i)) & 0xFF)*REFLECTANCEDMA_PERIOD_US;
+    decay[i+4] = ((hi >> (8*i)) & 0xFF)*REFLECTANCEDMA_PERIOD_US;
+  }
+}
+
+// ------------ReflectanceDMA_Buffer------------
+// Return the raw capture buffer.
+// Input: none
+// Output: pointer to REFLECTANCEDMA_SAMPLES bytes of P7->IN
+const uint8_t *ReflectanceDMA_Buffer(void){
+  return Buffer;
+}
+
+// ------------ReflectanceDMA_Compensate------------
+// Remove the ambient part of lit decay times.  The pin
+// discharges at a rate set by the total photocurrent, so
+// rates add: 1/t_ir = 1/t_lit - 1/t_dark, which gives
+// t_ir = t_lit*t_dark/(t_dark - t_lit).
+// Input: decay 8 lit decay times in us, corrected in place
+// Output: none
+void ReflectanceDMA_Compensate(uint16_t decay[8]){
+  int i;
+  for(i = 0; i < 8; i++){
+    uint32_t lit = decay[i];
+    uint32_t dark = Ambient[i];
+    uint32_t t;
+    if(dark >= FULL){
+      continue;                  // no measurable ambient on this sensor
+    }
+    if(dark <= lit){
+      t = FULL;                  // all of the discharge is ambient, no IR return
+    }else{
+      t = lit*dark/(dark - lit);
+      if(t > FULL) t = FULL;
+    }
+    decay[i] = t;
+  }
+}
+
+// ------------ReflectanceDMA_SetAmbientRate------------
+// Choose how often ReflectanceDMA_Tick() spends a capture
+// on ambient light.
+// Input: every one dark capture per this many, 0 to stop refreshing
+// Output: none
+void ReflectanceDMA_SetAmbientRate(uint16_t every){
+  AmbientEvery = every;
+  SinceDark = 0;
+}
+
+// ------------ReflectanceDMA_Tick------------
+// Run the differential capture pipeline, once per control
+// tick.  Processes the capture started on the previous tick
+// (a dark one refreshes Ambient[], a lit one is corrected
+// into decay[]) and then starts the next one.
+// Input: decay 8-element array for corrected decay times in us
+// Output: 1 if decay[] was updated, 0 if this tick's capture
+//         was dark or is still running
+uint8_t ReflectanceDMA_Tick(uint16_t decay[8]){
+  uint8_t fresh = 0;
+  uint32_t t0;
+
+  if(!ReflectanceDMA_Done()){
+    return 0;                    // called faster than a capture takes
+  }
+  if(Cost.Lit + Cost.Dark){      // skip the very first call, nothing captured yet
+    t0 = CycleCounter_Read();
+    if(Lit){
+      ReflectanceDMA_Decay(decay);
+      ReflectanceDMA_Compensate(decay);
+      Cost.LitCycles = CycleCounter_Read() - t0;
+      fresh = 1;
+    }else{
+      ReflectanceDMA_Decay(Ambient);
+      Cost.DarkCycles = CycleCounter_Read() - t0;
+    }
+  }
+
+  if(AmbientEvery && (++SinceDark >= AmbientEvery)){
+    SinceDark = 0;
+    Cost.Dark++;
+    ReflectanceDMA_Start(0);
+  }else{
+    Cost.Lit++;
+    ReflectanceDMA_Start(1);
+  }
+  return fresh;
+}
+
+// ------------ReflectanceDMA_GetCost------------
+// Return what ambient rejection is costing.
+// Input: none
+// Output: pointer to the counters
+const struct ReflectanceDMA_Cost *ReflectanceDMA_GetCost(void){
+  return &Cost;
+}
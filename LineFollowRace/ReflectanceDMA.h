@@ -0,0 +1,142 @@
+#ifndef REFLECTANCEDMA_H_
+#define REFLECTANCEDMA_H_
+
+/**
+ * @file      ReflectanceDMA.h
+ * @brief     Capture the QTR-8RC decay profile with DMA
+ * @details   After the charge pulse, Timer_A1 CCR0 triggers DMA channel 2
+ * every REFLECTANCEDMA_PERIOD_US, and each trigger copies P7->IN into
+ * an SRAM buffer.  The CPU is free, or asleep, for the whole capture.
+ * ReflectanceDMA_Decay() then turns the buffer into a decay time for
+ * each sensor.<br>
+ * For ambient-light rejection, ReflectanceDMA_Tick() interleaves
+ * captures with the IR LEDs off between the lit ones and subtracts
+ * the ambient photocurrent from each lit reading.
+<table>
+<caption id="ReflectanceDMA_res">Resources</caption>
+<tr><th>Resource      <th>Use
+<tr><td>Timer_A1 CCR0 <td>sample clock, SMCLK 12 MHz
+<tr><td>DMA channel 2 <td>trigger source 6, TA1CCR0
+<tr><td>P7.0-P7.7     <td>sensors, same as Reflectance.c
+</table>
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup RSLK_Input_Output
+ * @brief
+ * @{*/
+
+/**
+ * \brief time between samples, us
+ */
+#define REFLECTANCEDMA_PERIOD_US 10
+/**
+ * \brief samples per capture, 200 x 10 us = 2 ms
+ */
+#define REFLECTANCEDMA_SAMPLES   200
+
+/**
+ * What ambient rejection costs: captures spent dark instead
+ * of lit, and CPU cycles to process each kind
+ */
+struct ReflectanceDMA_Cost {
+  uint32_t Lit;          // lit captures started
+  uint32_t Dark;         // dark captures started, each one is a tick with no new reading
+  uint32_t LitCycles;    // cycles to extract and compensate the last lit capture
+  uint32_t DarkCycles;   // cycles to extract the last dark capture
+};
+
+/**
+ * Set up the DMA controller and its control table.
+ * @param  none
+ * @return none
+ * @note   Assumes Reflectance_Init() has been called
+ * @brief  Initialize DMA capture of the reflectance sensors
+ */
+void ReflectanceDMA_Init(void);
+
+/**
+ * <b>Start a capture and return immediately</b>:<br>
+  1) Turn on the 8 IR LEDs, unless <b>ir</b> is 0<br>
+  2) Pulse the 8 sensors high for 10 us<br>
+  3) Make the sensor pins input<br>
+  4) Start Timer_A1; DMA copies P7->IN every REFLECTANCEDMA_PERIOD_US<br>
+ * @param  ir 1 to light the IR LEDs, 0 to capture ambient light only
+ * @return none
+ * @note   Assumes ReflectanceDMA_Init() has been called
+ * @brief  Start a DMA capture of the decay profile
+ */
+void ReflectanceDMA_Start(uint8_t ir);
+
+/**
+ * Check for the end of a capture.  The first call that
+ * sees the DMA finished stops the timer and turns the IR LEDs off.
+ * @param  none
+ * @return 1 if the capture is complete, 0 if still running
+ * @brief  Poll for the end of a capture
+ */
+uint8_t ReflectanceDMA_Done(void);
+
+/**
+ * Extract the decay time of each sensor from the last capture.
+ * A sensor's decay time is the number of samples it read high,
+ * times REFLECTANCEDMA_PERIOD_US.  A sensor that never decayed
+ * reports REFLECTANCEDMA_SAMPLES*REFLECTANCEDMA_PERIOD_US.
+ * @param  decay 8-element array for the result in us, index 0 is P7.0
+ * @return none
+ * @note   Assumes ReflectanceDMA_Done() has returned 1
+ * @brief  Decay time of each sensor
+ */
+void ReflectanceDMA_Decay(uint16_t decay[8]);
+
+/**
+ * Return the raw capture buffer, one P7->IN byte per sample
+ * @param  none
+ * @return pointer to REFLECTANCEDMA_SAMPLES bytes
+ * @brief  Raw decay profile
+ */
+const uint8_t *ReflectanceDMA_Buffer(void);
+
+/**
+ * Remove the ambient part of lit decay times using the last
+ * dark capture.  Photocurrents add, so the IR-only decay time
+ * is t_lit*t_dark/(t_dark - t_lit).  Sensors that did not decay
+ * in the dark are left as they are.
+ * @param  decay 8 lit decay times in us, corrected in place
+ * @return none
+ * @brief  Subtract ambient light from decay times
+ */
+void ReflectanceDMA_Compensate(uint16_t decay[8]);
+
+/**
+ * Set how often ReflectanceDMA_Tick() refreshes the ambient
+ * reading.  Each refresh costs one tick without a new reading.
+ * @param  every one dark capture per <b>every</b> captures, 0 to never refresh
+ * @return none
+ * @brief  Set the ambient refresh rate
+ */
+void ReflectanceDMA_SetAmbientRate(uint16_t every);
+
+/**
+ * Run the differential capture pipeline; call once per control
+ * tick, at least 2 ms apart.  Finishes the capture started on the
+ * previous call, then starts the next one, lit or dark according
+ * to ReflectanceDMA_SetAmbientRate().
+ * @param  decay 8-element array for ambient-corrected decay times in us
+ * @return 1 if decay[] holds a new reading, 0 otherwise
+ * @note   Assumes ReflectanceDMA_Init() and CycleCounter_Init() have been called
+ * @brief  Differential lit/dark capture, one step
+ */
+uint8_t ReflectanceDMA_Tick(uint16_t decay[8]);
+
+/**
+ * Return the counters used to pick an ambient refresh rate
+ * @param  none
+ * @return pointer to the counters
+ * @brief  Cost of ambient rejection
+ */
+const struct ReflectanceDMA_Cost *ReflectanceDMA_GetCost(void);
+
+#endif /* REFLECTANCEDMA_H_ */
@@ -0,0 +1,182 @@
+// Sample.c
+// Runs on MSP432
+// Times each reflectance reading with Timer_A2 so that it is
+// latched just before the control step that uses it, and
+// measures how old readings are when the motors act on them.
+
+#include <stdint.h>
+#include "msp.h"
+#include "CortexM.h"
+#include "Reflectance.h"
+#include "Sample.h"
+#include "Trace.h"
+
+#define MAX_US 174000          // 65535 ticks at 375 kHz
+#define PULSE_US 10            // Reflectance_Start charge pulse
+#define SETUP_US 20            // least lead for arming CCR0
+
+static volatile uint8_t Fresh;   // 1 when Data has not been taken
+static volatile uint8_t Data;
+static uint8_t Mode;             // REFLECTANCE_ALLON or REFLECTANCE_STAGGERED
+static uint8_t Phase;            // staggered: 0 while the even bank decays, 1 the odd
+static uint16_t Bank;            // staggered: ticks from one bank's charge to the next
+static volatile uint32_t Latch;  // cycle count when Data was latched
+static uint32_t InUse;           // latch time of the reading the step is using
+static struct Sample_Stats Stats;
+
+// ------------ticks------------
+// Output: Timer_A2 ticks in us, at 375 kHz
+static uint16_t ticks(uint32_t us){
+  return (us*3)/8;
+}
+
+// ------------Sample_Init------------
+void Sample_Init(void){
+  TIMER_A2->CTL = 0x0004;      // stop and clear
+  TIMER_A2->EX0 = 0x0003;      // input divider /4
+  TIMER_A2->CCTL[0] = 0x0000;  // compare, no interrupt until scheduled
+  TIMER_A2->CCTL[1] = 0x0000;
+  NVIC_SetPriority(TA2_0_IRQn, 1);   // with the encoders, above the kernel
+  NVIC_SetPriority(TA2_N_IRQn, 1);
+  NVIC_EnableIRQ(TA2_0_IRQn);
+  NVIC_EnableIRQ(TA2_N_IRQn);
+  Fresh = 0;
+  InUse = 0;
+  Sample_Clear();
+  // bits9-8=10, SMCLK; bits7-6=11, /8; bits5-4=10, continuous; bit2=1, clear
+  TIMER_A2->CTL = 0x02E4;
+}
+
+// ------------Sample_Schedule------------
+// Input: us time until the release the reading is for
+//        wait sensor wait in us
+//        mode REFLECTANCE_ALLON, or REFLECTANCE_STAGGERED for
+//        the even bank and then the odd one
+// Output: 1 if scheduled, 0 if too late or too far away
+uint8_t Sample_Schedule(uint32_t us, uint32_t wait, uint8_t mode){
+  uint32_t bank = (mode == REFLECTANCE_STAGGERED) ? wait + PULSE_US : 0;   // the even bank runs first
+  uint32_t lead = bank + wait + PULSE_US + SAMPLE_GUARD_US;   // charge starts this long before the release
+  uint16_t now;
+  if((us > MAX_US) || (us < lead + SETUP_US)){
+    return 0;
+  }
+  Mode = mode;
+  Phase = 0;
+  Bank = ticks(bank);
+  now = TIMER_A2->R;
+  TIMER_A2->CCR[0] = now + ticks(us - lead);
+  TIMER_A2->CCR[1] = now + ticks(us - SAMPLE_GUARD_US - bank);
+  TIMER_A2->CCTL[0] = 0x0010;  // clear CCIFG, interrupt on compare
+  TIMER_A2->CCTL[1] = 0x0010;
+  return 1;
+}
+
+// ------------Sample_Get------------
+// Input: data where to put the reading
+// Output: 1 if it is new, 0 if there was none
+uint8_t Sample_Get(uint8_t *data){
+  if(Fresh == 0){
+    Sample_Cancel();             // too late for this step; the caller reads itself
+    return 0;
+  }
+  *data = Data;
+  InUse = Latch;
+  Fresh = 0;
+  Stats.Timed++;
+  return 1;
+}
+
+// ------------Sample_Cancel------------
+void Sample_Cancel(void){
+  TIMER_A2->CCTL[0] = 0x0000;
+  TIMER_A2->CCTL[1] = 0x0000;
+  Reflectance_End();             // LEDs off, if the charge had started
+  Fresh = 0;                     // a latched reading is dropped, not counted
+}
+
+// ------------Sample_Mark------------
+void Sample_Mark(void){
+  InUse = CycleCounter_Read();
+  Stats.Blocking++;
+}
+
+// ------------Sample_Actuated------------
+void Sample_Actuated(void){
+  uint32_t age, k, a;
+  if(InUse == 0){
+    return;                      // no reading yet
+  }
+  age = (CycleCounter_Read() - InUse)/48;   // 48 MHz core clock
+  Stats.Steps++;
+  Stats.TotalUs += age;
+  if(age < Stats.MinUs){
+    Stats.MinUs = age;
+  }
+  if(age > Stats.MaxUs){
+    Stats.MaxUs = age;
+  }
+  for(k = 0, a = age>>5; a && (k < SAMPLE_BINS-1); k++){
+    a = a>>1;
+  }
+  Stats.Bins[k]++;
+}
+
+// ------------Sample_GetStats------------
+const struct Sample_Stats *Sample_GetStats(void){
+  return &Stats;
+}
+
+// ------------Sample_Clear------------
+void Sample_Clear(void){
+  uint8_t k;
+  Stats.Steps = Stats.Timed = Stats.Blocking = 0;
+  Stats.MinUs = 0xFFFFFFFF;
+  Stats.MaxUs = Stats.TotalUs = 0;
+  for(k = 0; k < SAMPLE_BINS; k++){
+    Stats.Bins[k] = 0;
+  }
+}
+
+// ------------TA2_0_IRQHandler------------
+// Charge the sensors, or the even bank; the decay runs until CCR1.
+void TA2_0_IRQHandler(void){
+  TRACE_BEGIN(TRACE_SAMPLE);
+  TIMER_A2->CCTL[0] = 0x0000;    // acknowledge, once per schedule
+  if(Mode == REFLECTANCE_STAGGERED){
+    Reflectance_StartBank(REFLECTANCE_EVEN);
+  }else{
+    Reflectance_Start();
+  }
+  TRACE_END(TRACE_SAMPLE);
+}
+
+// ------------TA2_N_IRQHandler------------
+// Staggered, the first compare reads the even bank and charges
+// the odd one.  The last latches the reading for the next
+// control step.
+void TA2_N_IRQHandler(void){
+  uint8_t data;
+  TRACE_BEGIN(TRACE_SAMPLE);
+  if(TIMER_A2->CCTL[1]&0x0001){
+    if((Mode == REFLECTANCE_STAGGERED) && (Phase == 0)){
+      Data = Reflectance_EndBank(REFLECTANCE_EVEN);   // its LEDs off before the odd ones light
+      Reflectance_StartBank(REFLECTANCE_ODD);
+      TIMER_A2->CCR[1] += Bank;
+      TIMER_A2->CCTL[1] = 0x0010;  // clear CCIFG, interrupt on the odd bank's compare
+      Phase = 1;
+      TRACE_END(TRACE_SAMPLE);
+      return;
+    }
+    TIMER_A2->CCTL[1] = 0x0000;
+    if(Mode == REFLECTANCE_STAGGERED){
+      data = Data | Reflectance_EndBank(REFLECTANCE_ODD);
+    }else{
+      data = Reflectance_End();
+    }
+    Reflectance_Tally(Mode, data);
+    Data = data;
+    Latch = CycleCounter_Read();
+    Fresh = 1;
+  }
+  TRACE_END(TRACE_SAMPLE);
+}
@@ -0,0 +1,128 @@
+#ifndef SAMPLE_H_
+#define SAMPLE_H_
+
+/**
+ * @file      Sample.h
+ * @brief     Reflectance samples timed to land just before each control step
+ * @details   Instead of waiting for the sensors inside the control
+ * step, Sample_Schedule() has Timer_A2 start the next charge pulse
+ * (Reflectance_Start()) the sensor wait before the next release, and
+ * latch it (Reflectance_End()) SAMPLE_GUARD_US before that release.
+ * The discharge overlaps the end of the previous step and the idle
+ * time, and the next step finds its reading already taken.  With
+ * REFLECTANCE_STAGGERED the even bank is charged and read first and
+ * the odd bank right after it, so the step gets a staggered reading
+ * at the same rate as an all-on one.<br>
+ * Every step reports when it drove the motors with Sample_Actuated().
+ * The age of the reading at that moment, latch to actuation, is kept
+ * as a minimum, mean and maximum and as a histogram with bins that
+ * double in width, so pipelined and blocking reads can be compared.
+<table>
+<caption id="Sample_res">Resources</caption>
+<tr><th>Resource      <th>Use
+<tr><td>Timer_A2      <td>continuous, SMCLK/32 = 375 kHz
+<tr><td>TA2 CCR0      <td>charge pulse, TA2_0_IRQHandler
+<tr><td>TA2 CCR1      <td>latch, and the odd bank's charge when staggered, TA2_N_IRQHandler
+</table>
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup RSLK_Input_Output
+ * @brief
+ * @{*/
+
+/**
+ * \brief the latch comes this long before the release, us
+ */
+#define SAMPLE_GUARD_US 20
+/**
+ * \brief histogram bins; bin 0 is under 32 us, bin k is 2^(k+4) to 2^(k+5) us
+ */
+#define SAMPLE_BINS 10
+
+/**
+ * Age of readings when the motors were driven with them
+ */
+struct Sample_Stats {
+  uint32_t Steps;               // Sample_Actuated() calls counted
+  uint32_t Timed;               // readings latched by Timer_A2
+  uint32_t Blocking;            // readings taken in the step (Sample_Mark())
+  uint32_t MinUs;               // youngest reading at actuation
+  uint32_t MaxUs;               // oldest
+  uint32_t TotalUs;             // sum, for the mean
+  uint32_t Bins[SAMPLE_BINS];   // steps by age
+};
+
+/**
+ * Set up Timer_A2 and its interrupts.
+ * @param  none
+ * @return none
+ * @note   Assumes Reflectance_Init() and CycleCounter_Init() have been called
+ * @brief  Initialize timed sampling
+ */
+void Sample_Init(void);
+
+/**
+ * Take the next reading so that it is latched just before a time.
+ * Nothing is scheduled if there is not enough time for the wait,
+ * twice over when staggered.
+ * @param  us time from now to the release the reading is for
+ * @param  wait sensor wait, as for Reflectance_Read()
+ * @param  mode REFLECTANCE_ALLON, or REFLECTANCE_STAGGERED to read the banks one after the other
+ * @return 1 if scheduled, 0 if it is too late
+ * @brief  Schedule the next reading
+ */
+uint8_t Sample_Schedule(uint32_t us, uint32_t wait, uint8_t mode);
+
+/**
+ * Take the latched reading.  Each one is returned only once.
+ * @param  data where to put the 8-bit reading
+ * @return 1 if there was a new reading, 0 if not
+ * @brief  Latched reading
+ */
+uint8_t Sample_Get(uint8_t *data);
+
+/**
+ * Stop a scheduled reading and drop one already latched, without
+ * counting it, so the caller can read the sensors itself.
+ * @param  none
+ * @return none
+ * @brief  Cancel the scheduled reading
+ */
+void Sample_Cancel(void);
+
+/**
+ * Note that a reading was just taken some other way, so its age
+ * can be measured too.
+ * @param  none
+ * @return none
+ * @brief  Reading taken in the step
+ */
+void Sample_Mark(void);
+
+/**
+ * Count the age of the reading in use at the moment the motors were
+ * driven from it.
+ * @param  none
+ * @return none
+ * @brief  Motors driven
+ */
+void Sample_Actuated(void);
+
+/**
+ * @param  none
+ * @return ages so far
+ * @brief  Sample age statistics
+ */
+const struct Sample_Stats *Sample_GetStats(void);
+
+/**
+ * @param  none
+ * @return none
+ * @brief  Start the statistics again
+ */
+void Sample_Clear(void);
+
+#endif /* SAMPLE_H_ */
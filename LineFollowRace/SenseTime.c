@@ -0,0 +1,134 @@
+// SenseTime.c
+// Runs on MSP432
+// Tunes the Reflectance_Read wait to the surface from
+// occasional decay-time probes: just long enough for the
+// slowest white sensor to fall, with margin.
+
+#include <stdint.h>
+#include "Reflectance.h"
+#include "SenseTime.h"
+
+static struct SenseTime_Stats Stats;
+static uint32_t Since;           // reads since the last probe
+
+// ------------probe------------
+// Classify a probe at the current wait, then update the
+// estimates and the wait from it.
+// Input: decay 8 decay times in us
+//        max longest wait allowed
+// Output: 8-bit reading at the wait in use
+static uint8_t probe(const uint16_t decay[8], uint32_t max){
+  uint16_t s[8];
+  uint32_t white = 0, black = max;
+  uint32_t target, mid;
+  uint8_t data = 0;
+  int8_t i, j, split = -1;
+  for(i = 0; i < 8; i++){
+    if(decay[i] > Stats.Us){
+      data |= 1<<i;
+    }
+    for(j = i; (j > 0) && (s[j-1] > decay[i]); j--){   // insertion sort
+      s[j] = s[j-1];
+    }
+    s[j] = decay[i];
+  }
+  for(i = 0; i < 7; i++){        // largest jump of at least 2x
+    if((s[i+1] >= 2*s[i] + SENSETIME_MARGIN_US) &&
+       ((split < 0) || ((uint32_t)s[i+1]*s[split] > (uint32_t)s[split+1]*s[i]))){
+      split = i;
+    }
+  }
+  if(split >= 0){
+    white = s[split];
+    black = s[split+1];
+    Stats.Splits++;
+  }else{                         // one surface, or too little contrast to split
+    for(i = 0; i < 8; i++){
+      if((s[i] <= Stats.Us) && (s[i] > white)){
+        white = s[i];
+      }
+      if((s[i] > Stats.Us) && (s[i] < black)){
+        black = s[i];
+      }
+    }
+  }
+  Stats.Probes++;
+  if(white > Stats.White){
+    Stats.White = white;         // slower white: act at once
+  }else if(white){
+    Stats.White -= (Stats.White - white)>>4;
+  }
+  if(black < Stats.Black){
+    Stats.Black = black;         // faster black: act at once
+  }else{
+    Stats.Black += (black - Stats.Black)>>4;
+  }
+  if(Stats.White == 0){
+    return data;                 // no background seen yet, keep the wait
+  }
+  target = Stats.White + ((Stats.White/2 > SENSETIME_MARGIN_US) ? Stats.White/2 : SENSETIME_MARGIN_US);
+  mid = (Stats.White + Stats.Black)/2;
+  if((Stats.Black < max) && (target > mid)){
+    target = mid;                // poor contrast: split the difference
+  }
+  if(target < SENSETIME_MIN_US){
+    target = SENSETIME_MIN_US;
+  }
+  if(target > max){
+    target = max;
+  }
+  if(target > Stats.Us + SENSETIME_UP_US){
+    target = Stats.Us + SENSETIME_UP_US;
+  }else if(target + SENSETIME_DOWN_US < Stats.Us){
+    target = Stats.Us - SENSETIME_DOWN_US;
+  }
+  Stats.Us = target;
+  Stats.Hz = 1000000/(target + 10);
+  return data;
+}
+
+// ------------SenseTime_Init------------
+void SenseTime_Init(uint32_t us){
+  Stats.Us = us;
+  Stats.White = 0;
+  Stats.Black = 0xFFFF;
+  Stats.Probes = Stats.Splits = 0;
+  Stats.Hz = 1000000/(us + 10);
+  Since = SENSETIME_EVERY - 1;   // probe on the first read
+}
+
+// ------------SenseTime_Read------------
+// Input: max longest wait allowed
+// Output: 8-bit reading, 1 is black
+uint8_t SenseTime_Read(uint32_t max){
+  uint16_t decay[8];
+  if(Stats.Us > max){
+    Stats.Us = max;              // the limit was lowered
+    Stats.Hz = 1000000/(max + 10);
+  }
+  Since++;
+  if(Since < SENSETIME_EVERY){
+    return Reflectance_Read(Stats.Us);
+  }
+  Since = 0;
+  Reflectance_ReadDecay(max, decay);
+  return probe(decay, max);
+}
+
+// ------------SenseTime_Due------------
+// Output: 1 if the next SenseTime_Read will probe
+uint8_t SenseTime_Due(void){
+  return (Since + 1 >= SENSETIME_EVERY);
+}
+
+// ------------SenseTime_Count------------
+void SenseTime_Count(void){
+  if(Since + 1 < SENSETIME_EVERY){
+    Since++;                     // a due probe stays due
+  }
+}
+
+// ------------SenseTime_GetStats------------
+const struct SenseTime_Stats *SenseTime_GetStats(void){
+  return &Stats;
+}
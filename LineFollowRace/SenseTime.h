@@ -0,0 +1,109 @@
+#ifndef SENSETIME_H_
+#define SENSETIME_H_
+
+/**
+ * @file      SenseTime.h
+ * @brief     Reflectance_Read() wait tuned to the surface
+ * @details   A sensor over white falls well before one over black, and
+ * Reflectance_Read() only needs to wait long enough for every white
+ * sensor to fall.  SenseTime_Read() reads with the current wait, and
+ * every SENSETIME_EVERY calls times the decay of all eight sensors
+ * instead (Reflectance_ReadDecay()).<br>
+ * Each of those probes is split into line and background at the
+ * largest jump between the sorted decay times, when one is at least
+ * twice the other.  The slowest background sensor and the fastest line
+ * sensor are tracked; both move at once toward danger (a slower white,
+ * a faster black) and back by 1/16 of the difference.  The wait aimed
+ * for is half again the slowest white, at least SENSETIME_MARGIN_US
+ * over it, and never past the midpoint between white and black.  It
+ * is kept between SENSETIME_MIN_US and the caller's maximum, and
+ * moves at most SENSETIME_UP_US longer or SENSETIME_DOWN_US shorter
+ * per probe.
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup RSLK_Input_Output
+ * @brief
+ * @{*/
+
+/**
+ * \brief reads between decay probes
+ */
+#define SENSETIME_EVERY 50
+/**
+ * \brief shortest wait chosen, us
+ */
+#define SENSETIME_MIN_US 100
+/**
+ * \brief least wait beyond the slowest white sensor, us
+ */
+#define SENSETIME_MARGIN_US 50
+/**
+ * \brief most the wait grows per probe, us
+ */
+#define SENSETIME_UP_US 200
+/**
+ * \brief most the wait shrinks per probe, us
+ */
+#define SENSETIME_DOWN_US 50
+
+/**
+ * What the estimator has seen
+ */
+struct SenseTime_Stats {
+  uint32_t Us;         // wait in use
+  uint32_t White;      // slowest background decay, us, 0 before one is seen
+  uint32_t Black;      // fastest line decay, us, the maximum before one is seen
+  uint32_t Probes;     // decay probes taken
+  uint32_t Splits;     // probes that saw both line and background
+  uint32_t Hz;         // reads per second the wait allows, charge pulse included
+};
+
+/**
+ * Start the estimator.
+ * @param  us wait to start with
+ * @return none
+ * @brief  Initialize the sensor time estimator
+ */
+void SenseTime_Init(uint32_t us);
+
+/**
+ * Read the eight sensors with the tuned wait, or probe their decay
+ * times and return the same 8-bit reading from the probe.
+ * @param  max longest wait allowed, and the longest a probe waits
+ * @return 8-bit result, 1 is black
+ * @note   Assumes Reflectance_Init() has been called
+ * @note   A probe takes as long as the slowest sensor, up to max
+ * @brief  Read the sensors with the tuned wait
+ */
+uint8_t SenseTime_Read(uint32_t max);
+
+/**
+ * Check whether the next SenseTime_Read() will probe.  Counts
+ * nothing, so it can be asked before deciding how to read.
+ * @param  none
+ * @return 1 if a probe is due: call SenseTime_Read() for this reading
+ * @brief  Ask whether a probe is due
+ */
+uint8_t SenseTime_Due(void);
+
+/**
+ * Count a reading taken some other way with the tuned wait, such as
+ * one latched by Sample.h, toward the next probe.  Once a probe is
+ * due it stays due until SenseTime_Read() takes it.
+ * @param  none
+ * @return none
+ * @brief  Count a reading
+ */
+void SenseTime_Count(void);
+
+/**
+ * @param  none
+ * @return the wait in use and what it was chosen from
+ * @brief  Estimator state
+ */
+const struct SenseTime_Stats *SenseTime_GetStats(void);
+
+#endif /* SENSETIME_H_ */
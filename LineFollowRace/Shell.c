@@ -0,0 +1,207 @@
+// Shell.c
+// Runs on MSP432
+// Line-oriented command interpreter over UART0 for reading
+// and writing the parameter registry.  Never blocks.
+
+#include <stdint.h>
+#include <string.h>
+#include "UART0.h"
+#include "Param.h"
+#include "Shell.h"
+
+#define LINESIZE 40            // longest command line
+#define ROOM     64            // free FIFO space needed before printing a line
+
+static char Line[LINESIZE];
+static uint8_t Length;
+static int16_t ListNext;       // next parameter "list" will print, -1 when idle
+static struct {
+  const char *Name;
+  void (*Fn)(void);
+} Commands[SHELL_COMMANDS];
+static uint8_t NumCommands;
+
+// ------------prompt------------
+static void prompt(void){
+  UART0_OutString("\r\n> ");
+}
+
+// ------------show------------
+// Print one parameter as "name = value [min,max]".
+static void show(uint8_t index){
+  const struct Param *p = Param_Entry(index);
+  UART0_OutString(p->Name);
+  UART0_OutString(" = ");
+  UART0_OutSDec(Param_Get(index));
+  UART0_OutString(" [");
+  UART0_OutSDec(p->Min);
+  UART0_OutChar(',');
+  UART0_OutSDec(p->Max);
+  UART0_OutString("]\r\n");
+}
+
+// ------------number------------
+// Convert a decimal string, with optional minus sign.
+// Input: pt string
+//        value where to put the result
+// Output: 1 if pt was a number, 0 if not
+static uint8_t number(const char *pt, int32_t *value){
+  int32_t n = 0;
+  int32_t sign = 1;
+  if(*pt == '-'){
+    sign = -1;
+    pt++;
+  }
+  if(*pt == 0){
+    return 0;
+  }
+  while(*pt){
+    if((*pt < '0') || (*pt > '9') || (n > 99999999)){
+      return 0;
+    }
+    n = 10*n + (*pt - '0');
+    pt++;
+  }
+  *value = sign*n;
+  return 1;
+}
+
+// ------------split------------
+// Break Line into up to three space-separated words.
+// Output: number of words found
+static uint8_t split(char *word[3]){
+  uint8_t n = 0;
+  char *pt = Line;
+  while(*pt && (n < 3)){
+    while(*pt == ' '){
+      pt++;
+    }
+    if(*pt == 0){
+      break;
+    }
+    word[n++] = pt;
+    while(*pt && (*pt != ' ')){
+      pt++;
+    }
+    if(*pt){
+      *pt++ = 0;
+    }
+  }
+  return n;
+}
+
+// ------------execute------------
+// Run the command in Line.
+static void execute(void){
+  char *word[3];
+  uint8_t n = split(word);
+  int16_t index;
+  int32_t value;
+  uint8_t i;
+  if(n == 0){
+    prompt();
+    return;
+  }
+  if(strcmp(word[0], "help") == 0){
+    UART0_OutString("help, list, get name, set name value, save");
+    for(i = 0; i < NumCommands; i++){
+      UART0_OutString(", ");
+      UART0_OutString(Commands[i].Name);
+    }
+  }else if(strcmp(word[0], "list") == 0){
+    ListNext = 0;              // printed by Shell_Poll as the FIFO drains
+    return;
+  }else if(strcmp(word[0], "save") == 0){
+    UART0_OutString(Param_Save() ? "flash error" : "saved");
+  }else if((strcmp(word[0], "get") == 0) && (n == 2)){
+    index = Param_Find(word[1]);
+    if(index < 0){
+      UART0_OutString("unknown name");
+    }else{
+      show(index);
+      UART0_OutString("> ");
+      return;
+    }
+  }else if((strcmp(word[0], "set") == 0) && (n == 3)){
+    index = Param_Find(word[1]);
+    if(index < 0){
+      UART0_OutString("unknown name");
+    }else if((number(word[2], &value) == 0) || Param_Set(index, value)){
+      UART0_OutString("out of range");
+    }else{
+      UART0_OutString("ok");
+    }
+  }else{
+    for(i = 0; i < NumCommands; i++){
+      if(strcmp(word[0], Commands[i].Name) == 0){
+        Commands[i].Fn();
+        break;
+      }
+    }
+    if(i == NumCommands){
+      UART0_OutString("? try help");
+    }
+  }
+  prompt();
+}
+
+// ------------Shell_AddCommand------------
+// Input: name command word
+//        fn function that prints the report
+// Output: 0 if added, 1 if full
+uint8_t Shell_AddCommand(const char *name, void (*fn)(void)){
+  if(NumCommands >= SHELL_COMMANDS){
+    return 1;
+  }
+  Commands[NumCommands].Name = name;
+  Commands[NumCommands].Fn = fn;
+  NumCommands++;
+  return 0;
+}
+
+// ------------Shell_Init------------
+void Shell_Init(void){
+  Length = 0;
+  ListNext = -1;
+  prompt();
+}
+
+// ------------Shell_Poll------------
+// Finish any listing in progress, then consume received
+// characters up to the end of one line.
+void Shell_Poll(void){
+  char data;
+  if(ListNext >= 0){
+    if(UART0_TxRoom() < ROOM){
+      return;                  // wait for the listing to drain
+    }
+    if(ListNext < Param_Count()){
+      show(ListNext);
+      ListNext++;
+      return;
+    }
+    ListNext = -1;
+    UART0_OutString("> ");
+  }
+  while(UART0_InChar(&data)){
+    if((data == '\r') || (data == '\n')){
+      if((data == '\n') && (Length == 0)){
+        continue;              // second half of a CR LF
+      }
+      Line[Length] = 0;
+      Length = 0;
+      UART0_OutString("\r\n");
+      execute();
+      return;                  // at most one command per call
+    }
+    if((data == 0x08) || (data == 0x7F)){
+      if(Length){
+        Length--;
+        UART0_OutString("\b \b");
+      }
+    }else if((data >= ' ') && (Length < LINESIZE-1)){
+      Line[Length++] = data;
+      UART0_OutChar(data);     // echo
+    }
+  }
+}
@@ -0,0 +1,63 @@
+#ifndef SHELL_H_
+#define SHELL_H_
+
+/**
+ * @file      Shell.h
+ * @brief     Command interpreter for tuning parameters over UART0
+ * @details   Shell_Poll() is called from idle time in the control loop.
+ * Each call takes the characters already received, handles at most
+ * one complete line, and returns; it never waits for input or for
+ * the transmit FIFO.  Long output such as "list" is sent a line at a
+ * time over several calls as room appears in the FIFO.
+<table>
+<caption id="Shell_cmds">Commands</caption>
+<tr><th>Command  <th>Action
+<tr><td>help <td>show the commands
+<tr><td>list <td>show every parameter with its value and range
+<tr><td>get name <td>show one parameter
+<tr><td>set name value <td>change a parameter at the next control tick
+<tr><td>save <td>write all parameters to flash (robot parked)
+</table>
+ * Other modules' reports are added as commands with Shell_AddCommand().
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup RSLK_Input_Output
+ * @brief
+ * @{*/
+
+/**
+ * Reset the line buffer and print a prompt.
+ * @param  none
+ * @return none
+ * @note   Call after UART0_Init() and Param_Init()
+ * @brief  Initialize the shell
+ */
+void Shell_Init(void);
+
+/**
+ * \brief most commands that can be added
+ */
+#define SHELL_COMMANDS 24
+
+/**
+ * Add a command with no arguments.  Its function runs in the shell's
+ * task and should print one short report with UART0_OutString().
+ * @param  name command word, no spaces
+ * @param  fn function to run
+ * @return 0 if added, 1 if there is no room
+ * @brief  Add a shell command
+ */
+uint8_t Shell_AddCommand(const char *name, void (*fn)(void));
+
+/**
+ * Process received characters without waiting.
+ * @param  none
+ * @return none
+ * @brief  Run the shell for a moment
+ */
+void Shell_Poll(void);
+
+#endif /* SHELL_H_ */
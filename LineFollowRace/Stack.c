@@ -0,0 +1,118 @@
+// Stack.c
+// Runs on MSP432
+// Paints stacks so their high-water marks can be read at
+// run time, and makes the bottom 32 bytes of each one an
+// MPU no-access region so an overflow faults instead of
+// silently overwriting the variables below it.
+
+#include <stdint.h>
+#include "msp.h"
+#include "CortexM.h"
+#include "Motor.h"
+#include "Stack.h"
+
+extern uint32_t __stack;       // bottom of .stack, from the linker
+extern uint32_t __STACK_END;   // one past the top of .stack
+
+#define GUARDWORDS (STACK_GUARD/4)
+#define REGIONS 8              // MPU regions on the Cortex-M4
+
+#pragma NOINIT(Fault)
+static struct Stack_Fault Fault;
+static uint8_t NextRegion;
+static uint32_t *MainBottom;   // first word above the main stack guard
+
+// ------------guard------------
+// Make 32 bytes starting at addr a no-access region.
+// Input: addr 32-byte aligned
+// Output: 0 if done, 1 if every region is in use
+static uint8_t guard(uint32_t addr){
+  if(NextRegion >= REGIONS){
+    return 1;
+  }
+  MPU->RNR = NextRegion;
+  MPU->RBAR = addr;
+  // bit28=1, never execute; bits26-24=000, no access; bits5-1=4, 2^(4+1) bytes; bit0=1, enable
+  MPU->RASR = 0x10000000|(4<<1)|0x01;
+  NextRegion++;
+  return 0;
+}
+
+// ------------Stack_Init------------
+// The stack in use right now is not painted; everything
+// more than 64 bytes below this function's frame is.
+void Stack_Init(void){
+  uint32_t here;
+  uint32_t *pt;
+  uint32_t *top = &here - 16;
+  if(Fault.Magic != STACK_MAGIC){
+    Fault.Magic = STACK_MAGIC;       // first power up, RAM is random
+    Fault.Count = 0;
+    Fault.Cfsr = Fault.Address = Fault.Psp = 0;
+  }
+  NextRegion = 0;
+  pt = (uint32_t *)(((uint32_t)&__stack + STACK_GUARD - 1)&~(STACK_GUARD - 1));
+  MainBottom = pt + GUARDWORDS;
+  for(pt = MainBottom; pt < top; pt++){
+    *pt = STACK_PAINT;
+  }
+  MPU->CTRL = 0;
+  guard((uint32_t)(MainBottom - GUARDWORDS));
+  MPU->CTRL = 0x00000005;      // PRIVDEFENA: default map everywhere else; enable
+  SCB->SHCSR |= 0x00010000;    // MEMFAULTENA, else the fault escalates to HardFault
+  MemoryBarrier();
+}
+
+// ------------Stack_Prepare------------
+uint8_t Stack_Prepare(uint32_t *stack, uint32_t words){
+  uint32_t i;
+  uint8_t result;
+  for(i = GUARDWORDS; i < words; i++){
+    stack[i] = STACK_PAINT;
+  }
+  MPU->CTRL = 0;               // regions change while the MPU is off
+  result = guard((uint32_t)stack);
+  MPU->CTRL = 0x00000005;
+  MemoryBarrier();
+  return result;
+}
+
+// ------------Stack_Used------------
+// Find the lowest word above the guard that is no longer
+// paint; everything from there up has been used.
+uint32_t Stack_Used(const uint32_t *stack, uint32_t words){
+  uint32_t i;
+  for(i = GUARDWORDS; i < words; i++){
+    if(stack[i] != STACK_PAINT){
+      break;
+    }
+  }
+  return 4*(words - i);
+}
+
+// ------------Stack_MainUsed------------
+uint32_t Stack_MainUsed(void){
+  return Stack_Used(MainBottom - GUARDWORDS, &__STACK_END - (MainBottom - GUARDWORDS));
+}
+
+// ------------Stack_MainSize------------
+uint32_t Stack_MainSize(void){
+  return 4*(&__STACK_END - MainBottom);
+}
+
+// ------------Stack_GetFault------------
+const struct Stack_Fault *Stack_GetFault(void){
+  return &Fault;
+}
+
+// ------------MemManage_Handler------------
+// A stack ran into its guard (or some other MPU access
+// violation).  Stop, remember why, and start over.
+void MemManage_Handler(void){
+  Motor_Stop();
+  Fault.Count++;
+  Fault.Cfsr = SCB->CFSR;
+  Fault.Address = (SCB->CFSR & 0x80) ? SCB->MMFAR : 0;   // MMARVALID
+  Fault.Psp = GetPSP();
+  NVIC_SystemReset();
+}
@@ -0,0 +1,99 @@
+#ifndef STACK_H_
+#define STACK_H_
+
+/**
+ * @file      Stack.h
+ * @brief     Stack painting, high-water marks and MPU stack guards
+ * @details   Unused stack is filled with STACK_PAINT, so the deepest
+ * point a stack has ever reached is the lowest word that no longer
+ * holds the pattern.  The lowest 32 bytes of each guarded stack are
+ * an MPU region with no access at all: a push into it raises
+ * MemManage_Handler, which stops the motors, records the fault where
+ * the C startup will not clear it, and resets.<br>
+ * The main stack (the linker's .stack section) is painted and guarded
+ * by Stack_Init(); OS_AddTask() does the same for task stacks.  A
+ * fault while the main stack itself is full cannot be handled and
+ * locks up the processor instead.
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup MSP432
+ * @brief
+ * @{*/
+
+/**
+ * \brief value of a stack word that has never been used
+ */
+#define STACK_PAINT 0xA5A5A5A5
+/**
+ * \brief bytes of one guard region, the MPU minimum
+ */
+#define STACK_GUARD 32
+
+/**
+ * What MemManage_Handler found, kept across resets
+ */
+struct Stack_Fault {
+  uint32_t Magic;      // valid when STACK_MAGIC
+  uint32_t Count;      // MemManage faults since power up
+  uint32_t Cfsr;       // SCB->CFSR at the last fault
+  uint32_t Address;    // SCB->MMFAR at the last fault, if valid
+  uint32_t Psp;        // task stack pointer at the last fault
+};
+
+/**
+ * \brief marks a valid Stack_Fault
+ */
+#define STACK_MAGIC 0x53544B31
+
+/**
+ * Paint the unused part of the main stack, guard its bottom, and
+ * turn on the MPU and MemManage faults.
+ * @param  none
+ * @return none
+ * @note   Call from main() itself, not from deeper in the call tree
+ * @brief  Initialize stack checking
+ */
+void Stack_Init(void);
+
+/**
+ * Fill a stack with STACK_PAINT and guard its lowest STACK_GUARD bytes.
+ * @param  stack bottom of the stack, 32-byte aligned
+ * @param  words words to paint from the bottom
+ * @return 0 if guarded, 1 if it is painted but there is no MPU region left
+ * @brief  Prepare a task stack
+ */
+uint8_t Stack_Prepare(uint32_t *stack, uint32_t words);
+
+/**
+ * @param  stack bottom of a stack prepared with Stack_Prepare()
+ * @param  words size of the stack
+ * @return most bytes of it ever used, not counting the guard
+ * @brief  Stack high-water mark
+ */
+uint32_t Stack_Used(const uint32_t *stack, uint32_t words);
+
+/**
+ * @param  none
+ * @return most bytes of the main stack ever used
+ * @brief  Main stack high-water mark
+ */
+uint32_t Stack_MainUsed(void);
+
+/**
+ * @param  none
+ * @return usable bytes of the main stack, not counting the guard
+ * @brief  Main stack size
+ */
+uint32_t Stack_MainSize(void);
+
+/**
+ * @param  none
+ * @return fault record, valid across resets
+ * @brief  MemManage fault record
+ */
+const struct Stack_Fault *Stack_GetFault(void);
+
+#endif /* STACK_H_ */
@@ -0,0 +1,121 @@
+// Tach.c
+// Runs on MSP432
+// Measures wheel speed and travel from the encoders with
+// TIMER_A3 input capture.
+
+#include <stdint.h>
+#include "msp.h"
+#include "CortexM.h"
+#include "Tach.h"
+#include "Trace.h"
+
+#define TICKS_PER_SEC 187500   // SMCLK/8/8
+#define FORWARD_LEFT  0x04     // P5.2 level at a left A edge that means forward
+#define FORWARD_RIGHT 0x01     // P5.0 level at a right A edge that means forward
+
+static volatile uint32_t High;                // upper 16 bits of the extended count
+static volatile uint32_t Last[2];             // extended time of each wheel's last edge
+static volatile uint32_t Period[2];           // ticks between its last two edges, 0 if unknown
+static volatile int8_t Direction[2];          // 1 forward, -1 backward
+static volatile int32_t Count[2];
+
+// ------------now------------
+// Extend a 16-bit capture to 32 bits.  If the counter has
+// wrapped but the overflow interrupt has not run yet, a
+// small capture belongs after the wrap.
+// Input: capture TIMER_A3 value at the edge
+// Output: 32-bit time of the edge
+static uint32_t now(uint16_t capture){
+  uint32_t high = High;
+  if((TIMER_A3->CTL&0x0001) && (capture < 0x8000)){
+    high = high + 0x10000;                    // TAIFG still pending
+  }
+  return high|capture;
+}
+
+// ------------edge------------
+// Input: wheel TACH_LEFT or TACH_RIGHT
+//        capture TIMER_A3 value at the edge
+//        forward 1 if the B channel says forward
+static void edge(uint8_t wheel, uint16_t capture, uint8_t forward){
+  uint32_t t = now(capture);
+  if(Count[wheel] || Period[wheel] || Last[wheel]){
+    Period[wheel] = t - Last[wheel];
+  }
+  Last[wheel] = t;
+  Direction[wheel] = forward ? 1 : -1;
+  Count[wheel] += Direction[wheel];
+}
+
+// ------------Tach_Init------------
+void Tach_Init(void){
+  uint8_t i;
+  P10->SEL0 |= 0x30;           // P10.4 TA3CCP0, P10.5 TA3CCP1
+  P10->SEL1 &= ~0x30;
+  P10->DIR &= ~0x30;
+  P5->SEL0 &= ~0x05;           // P5.0, P5.2 GPIO inputs
+  P5->SEL1 &= ~0x05;
+  P5->DIR &= ~0x05;
+  for(i = 0; i < 2; i++){
+    Last[i] = Period[i] = 0;
+    Direction[i] = 1;
+    Count[i] = 0;
+  }
+  High = 0;
+  TIMER_A3->CTL = 0x0004;      // stop and clear
+  TIMER_A3->EX0 = 0x0007;      // input divider /8
+  // bits15-14=01, rising edge; bits13-12=00, CCIxA; bit11=1, synchronous; bit8=1, capture; bit4=1, interrupt
+  TIMER_A3->CCTL[0] = 0x4910;
+  TIMER_A3->CCTL[1] = 0x4910;
+  NVIC_SetPriority(TA3_0_IRQn, 1);   // equal priorities, so High never changes under an edge
+  NVIC_SetPriority(TA3_N_IRQn, 1);
+  NVIC_EnableIRQ(TA3_0_IRQn);
+  NVIC_EnableIRQ(TA3_N_IRQn);
+  // bits9-8=10, SMCLK; bits7-6=11, /8; bits5-4=10, continuous; bit2=1, clear; bit1=1, overflow interrupt
+  TIMER_A3->CTL = 0x02E6;
+}
+
+// ------------Tach_Speed------------
+// mm/s = (TICKS_PER_SEC/period edges/s)*(TACH_UM_PER_EDGE/1000 mm/edge)
+int32_t Tach_Speed(uint8_t wheel){
+  uint32_t period, age;
+  int32_t speed;
+  long sr = StartCritical();   // one consistent edge
+  period = Period[wheel];
+  age = now(TIMER_A3->R) - Last[wheel];
+  speed = Direction[wheel];
+  EndCritical(sr);
+  if((period == 0) || (age > TICKS_PER_SEC/1000*TACH_STALL_MS) || (period > TICKS_PER_SEC/1000*TACH_STALL_MS)){
+    return 0;
+  }
+  return speed*(int32_t)(((uint32_t)TICKS_PER_SEC*TACH_UM_PER_EDGE/1000)/period);
+}
+
+// ------------Tach_Count------------
+int32_t Tach_Count(uint8_t wheel){
+  return Count[wheel];
+}
+
+// ------------TA3_0_IRQHandler------------
+// Right encoder A rising edge.
+void TA3_0_IRQHandler(void){
+  TRACE_BEGIN(TRACE_TACH_RIGHT);
+  TIMER_A3->CCTL[0] &= ~0x0001;              // acknowledge CCIFG
+  edge(TACH_RIGHT, TIMER_A3->CCR[0], (P5->IN&0x01) == FORWARD_RIGHT);
+  TRACE_END(TRACE_TACH_RIGHT);
+}
+
+// ------------TA3_N_IRQHandler------------
+// Left encoder A rising edge, or the counter wrapped.
+void TA3_N_IRQHandler(void){
+  TRACE_BEGIN(TRACE_TACH_LEFT);
+  if(TIMER_A3->CCTL[1]&0x0001){
+    TIMER_A3->CCTL[1] &= ~0x0001;
+    edge(TACH_LEFT, TIMER_A3->CCR[1], (P5->IN&0x04) == FORWARD_LEFT);
+  }
+  if(TIMER_A3->CTL&0x0001){
+    TIMER_A3->CTL &= ~0x0001;                // acknowledge TAIFG
+    High = High + 0x10000;
+  }
+  TRACE_END(TRACE_TACH_LEFT);
+}
@@ -0,0 +1,67 @@
+#ifndef TACH_H_
+#define TACH_H_
+
+/**
+ * @file      Tach.h
+ * @brief     Wheel speed from the encoders, captured on TIMER_A3
+ * @details   Each wheel's encoder A channel is captured on its rising
+ * edge, 360 edges per wheel turn; the B channel, read at that moment,
+ * gives the direction.  TIMER_A3 counts SMCLK/64 (187,500 Hz) and is
+ * extended to 32 bits by its overflow interrupt, so a period is
+ * measured correctly however slowly the wheel turns.
+<table>
+<caption id="tach_pins">Encoder connections</caption>
+<tr><th>Pin<th>MSP432<th>Function
+<tr><td>P10.4<td>TA3CCP0<td>Right encoder A
+<tr><td>P5.0<td>GPIO<td>Right encoder B
+<tr><td>P10.5<td>TA3CCP1<td>Left encoder A
+<tr><td>P5.2<td>GPIO<td>Left encoder B
+</table>
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup RSLK_Input_Output
+ * @brief
+ * @{*/
+
+/**
+ * \brief wheel numbers for Tach_Speed() and Tach_Count()
+ */
+#define TACH_LEFT  0
+#define TACH_RIGHT 1
+/**
+ * \brief micrometers of travel per encoder edge, a 70 mm wheel over 360 edges
+ */
+#define TACH_UM_PER_EDGE 611
+/**
+ * \brief a wheel with no edge for this many ms is stopped
+ */
+#define TACH_STALL_MS 100
+
+/**
+ * Set up the encoder pins and start TIMER_A3 capturing.
+ * @param  none
+ * @return none
+ * @note   Assumes Clock_Init48MHz() has been called (SMCLK 12 MHz)
+ * @brief  Initialize the tachometers
+ */
+void Tach_Init(void);
+
+/**
+ * Speed from the most recent edge-to-edge period.
+ * @param  wheel TACH_LEFT or TACH_RIGHT
+ * @return wheel speed in mm/s, negative backward, 0 if stalled
+ * @brief  Wheel speed
+ */
+int32_t Tach_Speed(uint8_t wheel);
+
+/**
+ * @param  wheel TACH_LEFT or TACH_RIGHT
+ * @return edges since Tach_Init(), up forward and down backward
+ * @brief  Wheel position in encoder edges
+ */
+int32_t Tach_Count(uint8_t wheel);
+
+#endif /* TACH_H_ */
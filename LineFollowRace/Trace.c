@@ -0,0 +1,78 @@
+// Trace.c
+// Runs on MSP432
+// Records control stages, task switches and ISRs into an
+// SRAM buffer with cycle-counter times, one lap at a time,
+// for tools/trace2chrome.py.  Only built with TRACE defined.
+
+#include <stdint.h>
+#include "CortexM.h"
+#include "Clock.h"
+#include "Trace.h"
+
+#ifdef TRACE
+
+#define IDLE      0
+#define ARMED     1
+#define RECORDING 2
+#define DONE      3
+
+#pragma NOINIT(Trace)          // 16 kbytes the C startup need not clear
+struct Trace_Buffer Trace;
+
+static volatile uint8_t State = IDLE;
+static uint32_t Armed;         // mask to record with at the next marker
+static uint32_t Last;          // time of the last word written
+
+// ------------Trace_Arm------------
+void Trace_Arm(uint32_t mask){
+  Armed = mask;
+  State = mask ? ARMED : IDLE;
+}
+
+// ------------Trace_Marker------------
+void Trace_Marker(void){
+  long sr;
+  if(State == ARMED){
+    sr = StartCritical();
+    Trace.Magic = TRACE_MAGIC;
+    Trace.Hz = Clock_GetFreq();
+    Trace.Mask = Armed;
+    Trace.Count = 0;
+    Trace.Lost = 0;
+    Last = CycleCounter_Read();
+    State = RECORDING;
+    EndCritical(sr);
+  }else if(State == RECORDING){
+    State = DONE;
+  }
+}
+
+// ------------Trace_Event------------
+// Input: code event, with TRACE_ENDBIT at its end
+void Trace_Event(uint8_t code){
+  uint32_t now, high;
+  long sr;
+  if((State != RECORDING) || (((Trace.Mask>>(code&0x1F))&1) == 0)){
+    return;
+  }
+  sr = StartCritical();        // ISRs record too
+  now = CycleCounter_Read();
+  high = (now - Last)>>24;
+  if(Trace.Count + (high ? 2 : 1) > TRACE_SIZE){
+    Trace.Lost++;
+  }else{
+    if(high){
+      Trace.Event[Trace.Count++] = ((uint32_t)TRACE_GAP<<24)|high;
+    }
+    Trace.Event[Trace.Count++] = ((uint32_t)code<<24)|(now&0x00FFFFFF);
+    Last = now;
+  }
+  EndCritical(sr);
+}
+
+// ------------Trace_State------------
+uint8_t Trace_State(void){
+  return State;
+}
+
+#endif
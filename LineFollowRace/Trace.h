@@ -0,0 +1,129 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+/**
+ * @file      Trace.h
+ * @brief     Event trace of the control stages, task switches and ISRs
+ * @details   Build with TRACE defined to record, with the DWT cycle
+ * counter, when each control stage starts, which task the kernel
+ * switches to, and when each ISR begins and ends.  Without TRACE the
+ * TRACE_BEGIN() and TRACE_END() hooks compile to nothing and there is
+ * no buffer.<br>
+ * Each event is one 32-bit word: the event code in the top 8 bits and
+ * the low 24 bits of the cycle counter below it.  Times are rebuilt
+ * from the differences, so a gap of 2^24 cycles (349 ms) or more is
+ * preceded by a TRACE_GAP word that holds the rest.<br>
+ * Trace_Arm() waits for the start/finish marker (Trace_Marker()),
+ * records until the next marker or until the buffer is full, and then
+ * keeps what it has.  The buffer, Trace, is read with the debugger
+ * (Save Memory, raw binary or TI data format) and turned into a Chrome
+ * trace by tools/trace2chrome.py.
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup MSP432
+ * @brief
+ * @{*/
+
+/**
+ * \brief events the buffer holds, 16 kbytes
+ */
+#define TRACE_SIZE 4096
+
+/**
+ * \brief event codes; stages and tasks only begin, the next one of the group ends them
+ */
+enum Trace_Id {
+  TRACE_STAGE = 0,           // control stage 0-7 started (Watchdog_Stage)
+  TRACE_TASK = 8,            // kernel switching to task 0-7, 0 is idle
+  TRACE_STEP = 16,           // control step, Watchdog_Begin() to Watchdog_End()
+  TRACE_SYSTICK,             // kernel tick
+  TRACE_TACH_RIGHT,          // TA3_0, right encoder
+  TRACE_TACH_LEFT,           // TA3_N, left encoder or timer wrap
+  TRACE_BUMP,                // PORT4, bump switches
+  TRACE_UART,                // EUSCIA0
+  TRACE_WDT,                 // WDT_A hang backstop
+  TRACE_SAMPLE,              // TA2_0 and TA2_N, timed reflectance reading
+  TRACE_IDS,
+  TRACE_GAP = 0x7F           // not an event: bits 23-0 are bits 47-24 of the time to the next one
+};
+
+/**
+ * \brief added to a code when it ends
+ */
+#define TRACE_ENDBIT 0x80
+
+/**
+ * \brief marks a valid Trace_Buffer
+ */
+#define TRACE_MAGIC 0x54524331
+
+/**
+ * What the debugger saves
+ */
+struct Trace_Buffer {
+  uint32_t Magic;            // TRACE_MAGIC once recording has started
+  uint32_t Hz;               // cycle counter frequency
+  uint32_t Mask;             // bit n set when code n is recorded
+  uint32_t Count;            // words used in Event[]
+  uint32_t Lost;             // events dropped once Event[] was full
+  uint32_t Event[TRACE_SIZE];
+};
+
+#ifdef TRACE
+/**
+ * \brief the trace, in TRACE builds
+ */
+extern struct Trace_Buffer Trace;
+
+/**
+ * \brief mark the start of event id
+ */
+#define TRACE_BEGIN(id) Trace_Event(id)
+/**
+ * \brief mark the end of event id
+ */
+#define TRACE_END(id)   Trace_Event((id)|TRACE_ENDBIT)
+#else
+#define TRACE_BEGIN(id)
+#define TRACE_END(id)
+#endif
+
+/**
+ * Wait for the next Trace_Marker() and then record the codes in mask.
+ * The earlier trace stays readable until then.
+ * @param  mask bit n set to record code n, 0 to stop at once
+ * @return none
+ * @brief  Arm the trace
+ */
+void Trace_Arm(uint32_t mask);
+
+/**
+ * Start recording if armed, or stop if recording.
+ * @param  none
+ * @return none
+ * @note   Call at the start/finish marker
+ * @brief  Lap boundary
+ */
+void Trace_Marker(void);
+
+/**
+ * Record one event if its code is in the mask and there is room.
+ * Takes about 30 cycles; use TRACE_BEGIN() and TRACE_END().
+ * @param  code Trace_Id, plus TRACE_ENDBIT at the end of an event
+ * @return none
+ * @note   May be called from an ISR
+ * @brief  Record an event
+ */
+void Trace_Event(uint8_t code);
+
+/**
+ * @param  none
+ * @return 0 idle, 1 armed, 2 recording, 3 done
+ * @brief  Trace state
+ */
+uint8_t Trace_State(void);
+
+#endif /* TRACE_H_ */
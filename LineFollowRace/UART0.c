@@ -0,0 +1,154 @@
+// UART0.c
+// Runs on MSP432
+// Interrupt-driven serial I/O on eUSCI_A0 at 115200 bps.
+// The receive and transmit FIFOs are single-producer,
+// single-consumer rings, so the main program and the ISR
+// share them without disabling interrupts.
+
+// UCA0RXD (VCP receive) connected to P1.2
+// UCA0TXD (VCP transmit) connected to P1.3
+
+#include <stdint.h>
+#include "msp.h"
+#include "UART0.h"
+#include "Trace.h"
+
+static char TxFifo[UART0_TXSIZE];
+static volatile uint32_t TxPut, TxGet;   // TxPut written by main, TxGet by the ISR
+static char RxFifo[UART0_RXSIZE];
+static volatile uint32_t RxPut, RxGet;   // RxPut written by the ISR, RxGet by main
+static volatile uint32_t Lost;
+
+// ------------UART0_Init------------
+// Initialize eUSCI_A0 for 115200 bps, 8N1, with receive
+// interrupts on and transmit interrupts on demand.
+// Input: none
+// Output: none
+// Assumes: SMCLK = 12 MHz
+void UART0_Init(void){
+  TxPut = TxGet = 0;
+  RxPut = RxGet = 0;
+  Lost = 0;
+  EUSCI_A0->CTLW0 = 0x0001;       // hold the module in reset while configuring
+  // bit15=0, no parity; bit13=0, LSB first; bit12=0, 8 data bits
+  // bit11=0, 1 stop bit; bits10-9=00, UART mode; bits7-6=10, clock SMCLK
+  EUSCI_A0->CTLW0 = 0x0081;
+  // 12,000,000/115,200 = 104.17, oversampled: BRW=6, BRF=8, BRS=0x20
+  EUSCI_A0->BRW = 6;
+  EUSCI_A0->MCTLW = (0x20<<8)|(8<<4)|0x01;
+  P1->SEL0 |= 0x0C;
+  P1->SEL1 &= ~0x0C;              // configure P1.3 and P1.2 as primary module function
+  EUSCI_A0->CTLW0 &= ~0x0001;     // enable the module
+  EUSCI_A0->IFG &= ~0x0001;       // nothing received yet
+  EUSCI_A0->IE = 0x0001;          // receive interrupt on, transmit off until there is data
+  NVIC_SetPriority(EUSCIA0_IRQn, 5);   // below the control timing interrupts
+  NVIC_EnableIRQ(EUSCIA0_IRQn);
+}
+
+// ------------UART0_InChar------------
+// Take one character from the receive FIFO.
+// Input: data where to put it
+// Output: 1 if a character was returned, 0 if none
+uint8_t UART0_InChar(char *data){
+  if(RxGet == RxPut){
+    return 0;
+  }
+  *data = RxFifo[RxGet&(UART0_RXSIZE-1)];
+  RxGet = RxGet + 1;
+  return 1;
+}
+
+// ------------UART0_OutChar------------
+// Put one character in the transmit FIFO and make sure
+// the transmit interrupt is on to drain it.
+// Input: data character to send
+// Output: 1 if queued, 0 if dropped
+uint8_t UART0_OutChar(char data){
+  if((TxPut - TxGet) >= UART0_TXSIZE){
+    Lost = Lost + 1;
+    return 0;
+  }
+  TxFifo[TxPut&(UART0_TXSIZE-1)] = data;
+  TxPut = TxPut + 1;
+  EUSCI_A0->IE |= 0x0002;         // TXIFG is set while TXBUF is empty, so this starts sending
+  return 1;
+}
+
+// ------------UART0_OutString------------
+// Queue a null-terminated string.
+// Input: pt string to send
+// Output: number of characters queued
+uint32_t UART0_OutString(const char *pt){
+  uint32_t n = 0;
+  while(*pt){
+    if(UART0_OutChar(*pt) == 0){
+      break;
+    }
+    pt++;
+    n++;
+  }
+  return n;
+}
+
+// ------------UART0_OutSDec------------
+// Queue a signed decimal number.
+// Input: n number to send
+// Output: none
+void UART0_OutSDec(int32_t n){
+  char buf[11];
+  int i = 0;
+  uint32_t u = (uint32_t)n;
+  if(n < 0){
+    UART0_OutChar('-');
+    u = -u;
+  }
+  do{
+    buf[i++] = '0' + (u%10);
+    u = u/10;
+  }while(u);
+  while(i){
+    UART0_OutChar(buf[--i]);
+  }
+}
+
+// ------------UART0_TxRoom------------
+// Free space in the transmit FIFO.
+// Input: none
+// Output: characters that can be queued
+uint32_t UART0_TxRoom(void){
+  return UART0_TXSIZE - (TxPut - TxGet);
+}
+
+// ------------UART0_Lost------------
+// Characters dropped on a full FIFO.
+// Input: none
+// Output: count since UART0_Init
+uint32_t UART0_Lost(void){
+  return Lost;
+}
+
+// ------------EUSCIA0_IRQHandler------------
+// Move a received character into RxFifo, and the next
+// queued character into TXBUF.  Transmit interrupts are
+// turned off when TxFifo runs dry.
+void EUSCIA0_IRQHandler(void){
+  TRACE_BEGIN(TRACE_UART);
+  if(EUSCI_A0->IFG & 0x0001){     // reading RXBUF clears RXIFG
+    char data = EUSCI_A0->RXBUF;
+    if((RxPut - RxGet) < UART0_RXSIZE){
+      RxFifo[RxPut&(UART0_RXSIZE-1)] = data;
+      RxPut = RxPut + 1;
+    }else{
+      Lost = Lost + 1;
+    }
+  }
+  if((EUSCI_A0->IE & 0x0002) && (EUSCI_A0->IFG & 0x0002)){
+    if(TxGet != TxPut){
+      EUSCI_A0->TXBUF = TxFifo[TxGet&(UART0_TXSIZE-1)];   // writing TXBUF clears TXIFG
+      TxGet = TxGet + 1;
+    }else{
+      EUSCI_A0->IE &= ~0x0002;
+    }
+  }
+  TRACE_END(TRACE_UART);
+}
@@ -0,0 +1,94 @@
+#ifndef UART0_H_
+#define UART0_H_
+
+/**
+ * @file      UART0.h
+ * @brief     Interrupt-driven serial I/O on eUSCI_A0
+ * @details   115200 bps, 8 data bits, no parity, 1 stop bit, carried
+ * to the PC over the LaunchPad's USB debug connection.  Both directions
+ * go through software FIFOs serviced by EUSCIA0_IRQHandler, and no
+ * function here ever waits: output that does not fit is dropped and
+ * counted.
+<table>
+<caption id="UART0_pins">eUSCI_A0 pins</caption>
+<tr><th>Pin  <th>Function
+<tr><td>P1.2 <td>UCA0RXD, receive from PC
+<tr><td>P1.3 <td>UCA0TXD, transmit to PC
+</table>
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup RSLK_Input_Output
+ * @brief
+ * @{*/
+
+/**
+ * \brief bytes of transmit FIFO, a power of 2
+ */
+#define UART0_TXSIZE 256
+/**
+ * \brief bytes of receive FIFO, a power of 2
+ */
+#define UART0_RXSIZE 64
+
+/**
+ * Initialize eUSCI_A0 for 115200 bps and enable its interrupt.
+ * @param  none
+ * @return none
+ * @note   Assumes Clock_Init48MHz() has been called (SMCLK = 12 MHz)
+ * @brief  Initialize UART0
+ */
+void UART0_Init(void);
+
+/**
+ * Take one received character if there is one.
+ * @param  data where to put the character
+ * @return 1 if a character was returned, 0 if the receive FIFO is empty
+ * @brief  Non-blocking input
+ */
+uint8_t UART0_InChar(char *data);
+
+/**
+ * Queue one character for transmission.
+ * @param  data character to send
+ * @return 1 if queued, 0 if the transmit FIFO was full and it was dropped
+ * @brief  Non-blocking output
+ */
+uint8_t UART0_OutChar(char data);
+
+/**
+ * Queue a null-terminated string for transmission.
+ * Stops at the first character that does not fit.
+ * @param  pt string to send
+ * @return number of characters queued
+ * @brief  Non-blocking string output
+ */
+uint32_t UART0_OutString(const char *pt);
+
+/**
+ * Queue a signed decimal number for transmission.
+ * @param  n number to send
+ * @return none
+ * @brief  Non-blocking decimal output
+ */
+void UART0_OutSDec(int32_t n);
+
+/**
+ * Free space in the transmit FIFO.
+ * @param  none
+ * @return number of characters that can be queued without dropping
+ * @brief  Transmit room
+ */
+uint32_t UART0_TxRoom(void);
+
+/**
+ * Number of characters dropped because a FIFO was full.
+ * @param  none
+ * @return receive plus transmit overflows since UART0_Init()
+ * @brief  Lost characters
+ */
+uint32_t UART0_Lost(void);
+
+#endif /* UART0_H_ */
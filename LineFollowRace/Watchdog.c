@@ -0,0 +1,170 @@
+// Watchdog.c
+// Runs on MSP432
+// Times each control step against a budget, and keeps WDT_A
+// in interval mode as a backstop: an interval that passes
+// without Watchdog_End stops the motors, a second one in a
+// row resets the processor.  Until then, from early in main,
+// WDT_A runs in watchdog mode and resets a startup that hangs.
+
+#include <stdint.h>
+#include "msp.h"
+#include "CortexM.h"
+#include "Motor.h"
+#include "Watchdog.h"
+#include "Trace.h"
+
+#define ACLK 32768             // Hz, REFOCLK
+
+// WDT_A interval choices, bits2-0 of CTL, shortest first
+static const struct {
+  uint8_t Is;
+  uint32_t Us;
+} Intervals[] = {
+  {7, 1953},                   // 2^6 ACLK
+  {6, 15625},                  // 2^9
+  {5, 250000},                 // 2^13
+  {4, 1000000},                // 2^15
+};
+
+#pragma NOINIT(Record)
+static struct Watchdog_Record Record;
+static struct Watchdog_Stats Stats;
+static uint16_t Control;       // CTL without the password
+static uint32_t BudgetUs, HangUs;
+static uint32_t Budget;        // cycles
+static uint32_t Start;         // cycle counter at Watchdog_Begin
+static uint32_t StageStart;
+static uint8_t Stage;
+static uint32_t StageCycles[WATCHDOG_STAGES];
+static volatile uint8_t Misses;  // expiries since the last Watchdog_End
+
+// ------------Watchdog_Set------------
+void Watchdog_Set(uint32_t budget_us, uint32_t hang_us){
+  uint8_t i;
+  if(budget_us != BudgetUs){
+    BudgetUs = budget_us;
+    Budget = 48*budget_us;     // 48 MHz core clock
+  }
+  if(hang_us != HangUs){
+    HangUs = hang_us;
+    for(i = 0; i < sizeof(Intervals)/sizeof(Intervals[0]) - 1; i++){
+      if(Intervals[i].Us > hang_us){
+        break;
+      }
+    }
+    // bits6-5=01, ACLK; bit4=1, interval mode; bit3=1, clear count
+    Control = 0x0020|0x0010|0x0008|Intervals[i].Is;
+    WDT_A->CTL = WDT_A_CTL_PW|Control;
+  }
+}
+
+// ------------Watchdog_Boot------------
+// Watchdog mode from ACLK, which runs from REFOCLK out of
+// reset: an expiry resets the processor with no interrupt.
+void Watchdog_Boot(void){
+  // bits6-5=01, ACLK; bit4=0, watchdog mode; bit3=1, clear count;
+  // bits2-0=100, 2^15 ACLK is 1 s
+  WDT_A->CTL = WDT_A_CTL_PW|0x0020|0x0008|0x0004;
+}
+
+// ------------Watchdog_Init------------
+void Watchdog_Init(uint32_t budget_us, uint32_t hang_us){
+  uint8_t i;
+  if(Record.Magic != WATCHDOG_MAGIC){
+    Record.Magic = WATCHDOG_MAGIC;   // first power up, RAM is random
+    Record.Expiries = 0;
+    Record.Resets = 0;
+    Record.Stage = 0;
+    Record.Cycles = 0;
+  }
+  Stats.Steps = Stats.Overruns = Stats.NearMisses = 0;
+  Stats.MaxCycles = Stats.LastCycles = 0;
+  Stats.OverrunStage = 0;
+  for(i = 0; i < WATCHDOG_STAGES; i++){
+    StageCycles[i] = 0;
+  }
+  Misses = 0;
+  Start = StageStart = CycleCounter_Read();
+  BudgetUs = HangUs = 0;
+  Watchdog_Set(budget_us, hang_us);
+  NVIC_SetPriority(WDT_A_IRQn, 0);   // must preempt whatever has hung
+  NVIC_EnableIRQ(WDT_A_IRQn);
+}
+
+// ------------Watchdog_Begin------------
+void Watchdog_Begin(void){
+  TRACE_BEGIN(TRACE_STEP);
+  Start = StageStart = CycleCounter_Read();
+  Stage = 0;
+}
+
+// ------------Watchdog_Stage------------
+// Charge the time since the last mark to the stage that
+// was running.
+void Watchdog_Stage(uint8_t stage){
+  uint32_t now = CycleCounter_Read();
+  StageCycles[Stage] += now - StageStart;
+  StageStart = now;
+  Stage = stage&(WATCHDOG_STAGES-1);
+  TRACE_BEGIN(TRACE_STAGE + Stage);
+}
+
+// ------------Watchdog_End------------
+// Output: 1 if this step overran its budget
+uint8_t Watchdog_End(void){
+  uint32_t cycles, longest = 0;
+  uint8_t i, overrun = 0;
+  WDT_A->CTL = WDT_A_CTL_PW|Control;   // Control includes the count clear
+  Misses = 0;
+  Watchdog_Stage(0);
+  TRACE_END(TRACE_STEP);
+  cycles = CycleCounter_Read() - Start;
+  Stats.Steps++;
+  Stats.LastCycles = cycles;
+  if(cycles > Stats.MaxCycles){
+    Stats.MaxCycles = cycles;
+  }
+  if(cycles > Budget){
+    Stats.Overruns++;
+    overrun = 1;
+    for(i = 0; i < WATCHDOG_STAGES; i++){
+      if(StageCycles[i] > longest){
+        longest = StageCycles[i];
+        Stats.OverrunStage = i;
+      }
+    }
+  }else if(cycles > Budget - (Budget>>2)){
+    Stats.NearMisses++;
+  }
+  for(i = 0; i < WATCHDOG_STAGES; i++){
+    StageCycles[i] = 0;
+  }
+  return overrun;
+}
+
+// ------------Watchdog_GetStats------------
+const struct Watchdog_Stats *Watchdog_GetStats(void){
+  return &Stats;
+}
+
+// ------------Watchdog_GetRecord------------
+const struct Watchdog_Record *Watchdog_GetRecord(void){
+  return &Record;
+}
+
+// ------------WDT_A_IRQHandler------------
+// A whole interval passed with no Watchdog_End.  The flag
+// clears itself when this interrupt is serviced.
+void WDT_A_IRQHandler(void){
+  TRACE_BEGIN(TRACE_WDT);
+  Motor_Stop();
+  Record.Expiries++;
+  Record.Stage = Stage;
+  Record.Cycles = CycleCounter_Read() - Start;
+  Misses++;
+  if(Misses >= 2){
+    Record.Resets++;
+    NVIC_SystemReset();        // pins go back to inputs and the motor drivers sleep
+  }
+  TRACE_END(TRACE_WDT);
+}
@@ -0,0 +1,134 @@
+#ifndef WATCHDOG_H_
+#define WATCHDOG_H_
+
+/**
+ * @file      Watchdog.h
+ * @brief     Control-step deadline monitor and WDT_A hang backstop
+ * @details   Two layers watch the control step.<br>
+ * 1) Watchdog_Begin() and Watchdog_End() time every step with the cycle
+ * counter against a budget and count overruns and near misses, naming
+ * the stage (marked with Watchdog_Stage()) that took longest in each
+ * overrun step.<br>
+ * 2) WDT_A runs in interval mode from ACLK (32,768 Hz) and is cleared
+ * by Watchdog_End().  If a step hangs, WDT_A_IRQHandler stops the
+ * motors and records where; if the next interval passes without a
+ * Watchdog_End() as well, it resets the processor.  The record is kept
+ * in RAM that the C startup does not clear, so it survives that reset.
+ * <br>
+ * Startup is covered too: Watchdog_Boot(), called first thing in
+ * main(), runs WDT_A in watchdog mode, which resets the processor
+ * if the clock, drivers or scheduler do not reach Watchdog_Init()
+ * within a second.  That reset leaves no record.<br>
+ * A hang with interrupts disabled is not caught; the critical sections
+ * in this program are all short.
+ ******************************************************************************/
+
+#include <stdint.h>
+
+/*!
+ * @defgroup MSP432
+ * @brief
+ * @{*/
+
+/**
+ * \brief most stage numbers the application may use
+ */
+#define WATCHDOG_STAGES 8
+
+/**
+ * Counters since Watchdog_Init()
+ */
+struct Watchdog_Stats {
+  uint32_t Steps;          // steps timed
+  uint32_t Overruns;       // steps longer than the budget
+  uint32_t NearMisses;     // steps over 3/4 of the budget but within it
+  uint32_t MaxCycles;      // longest step
+  uint32_t LastCycles;     // length of the most recent step
+  uint8_t OverrunStage;    // longest stage of the most recent overrun step
+};
+
+/**
+ * What WDT_A_IRQHandler found, kept across resets
+ */
+struct Watchdog_Record {
+  uint32_t Magic;          // valid when WATCHDOG_MAGIC
+  uint32_t Expiries;       // WDT_A intervals that passed with no Watchdog_End()
+  uint32_t Resets;         // resets forced after a second expiry
+  uint8_t Stage;           // stage at the most recent expiry
+  uint32_t Cycles;         // time since Watchdog_Begin() at that expiry
+};
+
+/**
+ * \brief marks a valid Watchdog_Record
+ */
+#define WATCHDOG_MAGIC 0x57445431
+
+/**
+ * Run WDT_A in watchdog mode with a 1 s timeout, so a hang before
+ * the control task starts resets the processor.  Watchdog_Init()
+ * switches it to interval mode.
+ * @param  none
+ * @return none
+ * @note   Call before Clock_Start48MHz(); ACLK is REFOCLK from reset
+ * @brief  Guard startup
+ */
+void Watchdog_Boot(void);
+
+/**
+ * Start WDT_A with the shortest interval longer than hang_us and set
+ * the step budget.  Keeps the record of earlier resets.
+ * @param  budget_us longest acceptable step
+ * @param  hang_us time without a Watchdog_End() that counts as a hang, at most 1,000,000
+ * @return none
+ * @note   hang_us must cover the loop period plus the budget
+ * @brief  Start the watchdog
+ */
+void Watchdog_Init(uint32_t budget_us, uint32_t hang_us);
+
+/**
+ * Change the budget or the hang time.  Cheap when neither changed,
+ * so it may be called every step with the tunable values.
+ * @param  budget_us longest acceptable step
+ * @param  hang_us time without a Watchdog_End() that counts as a hang
+ * @return none
+ * @brief  Reconfigure the watchdog
+ */
+void Watchdog_Set(uint32_t budget_us, uint32_t hang_us);
+
+/**
+ * @param  none
+ * @return none
+ * @brief  Mark the start of a control step
+ */
+void Watchdog_Begin(void);
+
+/**
+ * @param  stage what the step is doing now, below WATCHDOG_STAGES
+ * @return none
+ * @brief  Mark a stage of the control step
+ */
+void Watchdog_Stage(uint8_t stage);
+
+/**
+ * Time the step against the budget and clear WDT_A.
+ * @param  none
+ * @return 1 if the step overran the budget, 0 if not
+ * @brief  Mark the end of a control step
+ */
+uint8_t Watchdog_End(void);
+
+/**
+ * @param  none
+ * @return step counters
+ * @brief  Deadline statistics
+ */
+const struct Watchdog_Stats *Watchdog_GetStats(void);
+
+/**
+ * @param  none
+ * @return hang record, valid across resets
+ * @brief  Hang record
+ */
+const struct Watchdog_Record *Watchdog_GetRecord(void);
+
+#endif /* WATCHDOG_H_ */
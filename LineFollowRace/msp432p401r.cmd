@@ -44,7 +44,9 @@
 
 MEMORY
 {
-    MAIN       (RX) : origin = 0x00000000, length = 0x00040000
+    MAIN       (RX) : origin = 0x00000000, length = 0x0003E000
+    /* last two sectors of bank 1 hold data written at run time, see Flash.h */
+    FLASH_DATA (RX) : origin = 0x0003E000, length = 0x00002000
     INFO       (RX) : origin = 0x00200000, length = 0x00004000
 #ifdef  __TI_COMPILER_VERSION__
 #if     __TI_COMPILER_VERSION__ >= 15009000
@@ -123,6 +125,7 @@ SECTIONS
     .vtable :   > 0x20000000
     .data   :   > SRAM_DATA
     .bss    :   > SRAM_DATA
+    .TI.noinit :  > SRAM_DATA      /* #pragma NOINIT, kept across resets */
     .sysmem :   > SRAM_DATA
     .stack  :   > SRAM_DATA (HIGH)
 
@@ -0,0 +1,47 @@
+// cortexm.c
+// Runs on the host
+// The CortexM.h exclusive access functions for the host tests,
+// with C11 atomics.  Each thread plays one context: Exclusive_Load
+// remembers the address and value, and Exclusive_Store succeeds only
+// if the word still holds that value.  Like STREX after an interrupt,
+// a store also fails now and then for no reason, so the retry paths
+// run.
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "CortexM.h"
+
+static _Thread_local volatile uint32_t *Addr;   // 0 when no access is open
+static _Thread_local uint32_t Value;
+static _Thread_local uint32_t Stores;
+
+// ------------Exclusive_Load------------
+uint32_t Exclusive_Load(volatile uint32_t *addr){
+  Addr = addr;
+  Value = atomic_load((_Atomic uint32_t *)addr);
+  return Value;
+}
+
+// ------------Exclusive_Store------------
+// Output: 0 if stored, 1 if not
+uint32_t Exclusive_Store(volatile uint32_t *addr, uint32_t value){
+  uint32_t expected = Value;
+  if(addr != Addr){
+    return 1;                  // no open access to this word
+  }
+  Addr = 0;
+  if((++Stores%7) == 0){
+    return 1;                  // as if an interrupt came between
+  }
+  return !atomic_compare_exchange_strong((_Atomic uint32_t *)addr, &expected, value);
+}
+
+// ------------Exclusive_Clear------------
+void Exclusive_Clear(void){
+  Addr = 0;
+}
+
+// ------------MemoryBarrier------------
+void MemoryBarrier(void){
+  atomic_thread_fence(memory_order_seq_cst);
+}
@@ -0,0 +1,80 @@
+// eventtest.c
+// Runs on the host
+// Stress test of the Event.c queue: EVENTTEST_PRODUCERS threads
+// each put a numbered run of events while main() is the one
+// consumer.  Every producer's events must come out once each and
+// in order, and a full queue must refuse a put rather than lose
+// or overwrite an event.  The producer is the event type, the
+// number is its data.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+#include "Event.h"
+
+#define EVENTTEST_PRODUCERS 4
+#define EVENTTEST_EVENTS    1000000   // per producer, fits in the 24-bit data
+
+
+// ------------producer------------
+static void *producer(void *arg){
+  uint32_t id = (uint32_t)(uintptr_t)arg;
+  uint32_t i;
+  for(i = 0; i < EVENTTEST_EVENTS; i++){
+    while(Event_Put(EVENT(id, i)) == 0){
+      sched_yield();           // full: let the consumer make room
+    }
+  }
+  return 0;
+}
+
+int main(void){
+  pthread_t thread[EVENTTEST_PRODUCERS];
+  uint32_t next[EVENTTEST_PRODUCERS] = {0};
+  uint32_t event, id, data, total = 0, lost = 0;
+  uint32_t bad = 0;
+  const struct Event_Stats *s;
+  int i;
+
+  Event_Init();
+  for(i = 0; i < EVENTTEST_PRODUCERS; i++){
+    pthread_create(&thread[i], 0, producer, (void *)(uintptr_t)(i + 1));
+  }
+  while(total < EVENTTEST_PRODUCERS*EVENTTEST_EVENTS){
+    if(Event_Get(&event) == 0){
+      sched_yield();
+      continue;
+    }
+    id = EVENT_TYPE(event) - 1;
+    data = EVENT_DATA(event);
+    if((id >= EVENTTEST_PRODUCERS) || (data != next[id])){
+      if(bad < 10){
+        printf("producer %u: got %u, expected %u\n", id + 1, data, next[id]);
+      }
+      bad++;
+    }
+    if(id < EVENTTEST_PRODUCERS){
+      next[id] = data + 1;
+    }
+    total++;
+  }
+  for(i = 0; i < EVENTTEST_PRODUCERS; i++){
+    pthread_join(thread[i], 0);
+  }
+  if(Event_Get(&event)){
+    printf("an event was left over\n");
+    bad++;
+  }
+  s = Event_GetStats();
+  for(i = 0; i < EVENT_TYPES; i++){
+    lost += s->Lost[i];
+  }
+  if(s->Put != total){
+    printf("Put %u, taken %u\n", s->Put, total);
+    bad++;
+  }
+  printf("events %u retries %u refused when full %u out of order %u\n",
+         total, s->Retries, lost, bad);
+  return bad != 0;
+}
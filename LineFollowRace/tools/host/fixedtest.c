@@ -0,0 +1,115 @@
+// fixedtest.c
+// Runs on the host
+// Bit-exact check of the Fixed.c 8-channel kernels.  The SIMD
+// versions (Fixed_Dot8, Fixed_Normalize8, built with the DSP
+// intrinsics of msp.h) and the C versions (Fixed_Dot8C,
+// Fixed_Normalize8C) must both equal a reference written here
+// from the definitions in Fixed.h, on random vectors and on
+// vectors made of the values where saturation and rounding
+// change: the ends of the Q15 range, 0, +/-1 and the gain of 1.0.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "Fixed.h"
+
+#define FIXEDTEST_VECTORS 1000000
+
+static const int16_t Edge[] = {-32768, -32767, -256, -1, 0, 1, 255, 256, 32766, 32767};
+#define EDGES (sizeof(Edge)/sizeof(Edge[0]))
+
+// ------------sat------------
+static int32_t sat(int64_t x, int64_t min, int64_t max){
+  if(x > max) return (int32_t)max;
+  if(x < min) return (int32_t)min;
+  return (int32_t)x;
+}
+
+// ------------dot------------
+// sum of x[i]*w[i], saturated to 32 bits once at the end
+static int32_t dot(const int16_t x[8], const int16_t w[8]){
+  int64_t sum = 0;
+  int i;
+  for(i = 0; i < 8; i++){
+    sum += (int64_t)x[i]*w[i];
+  }
+  return sat(sum, INT32_MIN, INT32_MAX);
+}
+
+// ------------normalize------------
+// Sat((Sat(x-offset)*gain) >> FIXED_GAIN_SHIFT), the shift
+// rounding down
+static void normalize(const int16_t x[8], const int16_t offset[8], const int16_t gain[8], int16_t y[8]){
+  int64_t d, p;
+  int i;
+  for(i = 0; i < 8; i++){
+    d = sat((int64_t)x[i] - offset[i], FIXED_MIN, FIXED_MAX);
+    p = d*gain[i];
+    if(p < 0){
+      p = -((-p + (1 << FIXED_GAIN_SHIFT) - 1) >> FIXED_GAIN_SHIFT);
+    }else{
+      p = p >> FIXED_GAIN_SHIFT;
+    }
+    y[i] = (int16_t)sat(p, FIXED_MIN, FIXED_MAX);
+  }
+}
+
+// ------------fill------------
+// random values, or only edge values on odd vectors
+static void fill(int16_t v[8], long n){
+  int i;
+  for(i = 0; i < 8; i++){
+    v[i] = (n & 1) ? Edge[rand()%EDGES] : (int16_t)rand();
+  }
+}
+
+int main(void){
+  int16_t x[8], w[8], offset[8], gain[8], y[8], yc[8], yref[8], inplace[8];
+  int32_t ref;
+  uint32_t bad = 0;
+  long n;
+  int i;
+  if(Fixed_Simd() == 0){
+    printf("Fixed.c did not build its SIMD kernels\n");
+    return 1;
+  }
+  srand(1);
+  for(n = 0; n < FIXEDTEST_VECTORS; n++){
+    fill(x, n);
+    fill(w, n);
+    fill(offset, n);
+    fill(gain, n);
+    ref = dot(x, w);
+    if((Fixed_Dot8(x, w) != ref) || (Fixed_Dot8C(x, w) != ref)){
+      if(bad < 10){
+        printf("dot %ld: reference %d simd %d c %d\n", n, ref, Fixed_Dot8(x, w), Fixed_Dot8C(x, w));
+      }
+      bad++;
+    }
+    normalize(x, offset, gain, yref);
+    Fixed_Normalize8(x, offset, gain, y);
+    Fixed_Normalize8C(x, offset, gain, yc);
+    for(i = 0; i < 8; i++){
+      inplace[i] = x[i];
+    }
+    Fixed_Normalize8(inplace, offset, gain, inplace);   // y may be x
+    for(i = 0; i < 8; i++){
+      if((y[i] != yref[i]) || (yc[i] != yref[i]) || (inplace[i] != yref[i])){
+        if(bad < 10){
+          printf("normalize %ld lane %d: reference %d simd %d c %d in place %d\n",
+                 n, i, yref[i], y[i], yc[i], inplace[i]);
+        }
+        bad++;
+      }
+    }
+  }
+  for(i = 0; i < 8; i++){
+    x[i] = w[i] = FIXED_MIN;   // 8 x 2^30 is the one sum that saturates
+  }
+  if(Fixed_Dot8(x, w) != INT32_MAX){
+    printf("-1.0 . -1.0 is %d, not saturated\n", Fixed_Dot8(x, w));
+    bad++;
+  }
+  printf("vectors %d mismatches %u\n", FIXEDTEST_VECTORS, bad);
+  return bad != 0;
+}
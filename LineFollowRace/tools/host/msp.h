@@ -0,0 +1,44 @@
+// msp.h
+// Runs on the host
+// Stand-in for the TI device header: the registers of msp432.h,
+// and the Cortex-M4 DSP intrinsics Fixed.c uses, written out in C
+// as the ARM architecture manual defines them.  As macros, like
+// the TI compiler's, they make Fixed.c build its SIMD kernels.
+
+#ifndef MSP_H_
+#define MSP_H_
+
+#include <stdint.h>
+#include "msp432.h"
+
+// ------------Host_SSAT------------
+// SSAT: x saturated to a signed n-bit range
+static inline int32_t Host_SSAT(int32_t x, uint32_t n){
+  int32_t max = (int32_t)((1u << (n - 1)) - 1);
+  int32_t min = -max - 1;
+  if(x > max) return max;
+  if(x < min) return min;
+  return x;
+}
+
+// ------------Host_QSUB16------------
+// QSUB16: both 16-bit lanes of a-b, each saturated
+static inline uint32_t Host_QSUB16(uint32_t a, uint32_t b){
+  int32_t lo = Host_SSAT((int32_t)(int16_t)a - (int16_t)b, 16);
+  int32_t hi = Host_SSAT((int32_t)(int16_t)(a >> 16) - (int16_t)(b >> 16), 16);
+  return ((uint32_t)lo & 0xFFFF) | ((uint32_t)hi << 16);
+}
+
+// ------------Host_SMLALD------------
+// SMLALD: both lane products added to a 64-bit accumulator
+static inline uint64_t Host_SMLALD(uint32_t a, uint32_t b, uint64_t sum){
+  int64_t lo = (int64_t)(int16_t)a*(int16_t)b;
+  int64_t hi = (int64_t)(int16_t)(a >> 16)*(int16_t)(b >> 16);
+  return (uint64_t)((int64_t)sum + lo + hi);
+}
+
+#define __SSAT(x, n)        Host_SSAT((x), (n))
+#define __QSUB16(a, b)      Host_QSUB16((a), (b))
+#define __SMLALD(a, b, sum) Host_SMLALD((a), (b), (sum))
+
+#endif /* MSP_H_ */
@@ -0,0 +1,37 @@
+// msp432.h
+// Runs on the host
+// Stand-in for the TI device header, with only the registers the
+// sources built by the host tests touch.  Each peripheral is a plain
+// struct in target.c, so writes land in memory and reads return what
+// a test put there.
+
+#ifndef MSP432_H_
+#define MSP432_H_
+
+#include <stdint.h>
+
+typedef struct {
+  volatile uint8_t IN;
+  volatile uint8_t OUT;
+  volatile uint8_t DIR;
+  volatile uint8_t SEL0;
+  volatile uint8_t SEL1;
+} DIO_PORT_Type;
+
+typedef struct {
+  volatile uint16_t CTL;
+  volatile uint16_t CCTL[7];
+  volatile uint16_t R;
+  volatile uint16_t CCR[7];
+  volatile uint16_t EX0;
+} Timer_A_Type;
+
+extern DIO_PORT_Type Host_P5, Host_P7, Host_P9;
+extern Timer_A_Type Host_TA1;
+
+#define P5       (&Host_P5)
+#define P7       (&Host_P7)
+#define P9       (&Host_P9)
+#define TIMER_A1 (&Host_TA1)
+
+#endif /* MSP432_H_ */
@@ -0,0 +1,151 @@
+// odometrytest.c
+// Runs on the host
+// Drives Odometry.c with encoder counts computed for known paths
+// and checks the pose it integrates:
+// - a quarter circle, as BENCH_ODOMETRY runs it, must end within
+//   1 mm and 0.2 degrees of where it should;
+// - a circle driven three times with wheels 5% further apart than
+//   ODOMETRY_GAIN assumes must have its gain rescaled at the
+//   second marker, and then close every lap within 2 mm;
+// - a straight run centered on the line with one wheel slipping
+//   must keep its heading at 0 and count the slip as drift;
+// - a steady curve centered on the line must not be held.
+
+#include <stdio.h>
+#include <stdint.h>
+#include "Tach.h"
+#include "Odometry.h"
+
+#define TURN 4294967296.0      // heading units in one turn
+
+static uint32_t Bad;
+
+// ------------edges------------
+// Input: um wheel travel
+// Output: encoder edges counted over it
+static int32_t edges(int64_t um){
+  return (int32_t)(um/TACH_UM_PER_EDGE);
+}
+
+// ------------degrees------------
+// Input: heading 2^32 per turn
+// Output: the same angle in degrees, -180 to 180
+static double degrees(uint32_t heading){
+  return (int32_t)heading*360.0/TURN;
+}
+
+// ------------check------------
+// Count and report a failed condition.
+static void check(int ok, const char *what, double value){
+  if(!ok){
+    printf("%s: %.3f\n", what, value);
+    Bad++;
+  }
+}
+
+// ------------quarter------------
+// Quarter circle of 500 mm radius in 5 mm steps, the wheels
+// 140 mm apart; ends at (500, 500) mm facing 90 degrees.
+static void quarter(void){
+  const struct Odometry_Pose *p = Odometry_Get();
+  int32_t n;
+  Odometry_Init(0, 0);
+  for(n = 1; n <= 157; n++){     // 157*5 mm is a quarter of 3142 mm
+    Odometry_Update(edges((int64_t)n*5000*430/500), edges((int64_t)n*5000*570/500));
+  }
+  printf("quarter x %.2f mm y %.2f mm heading %.2f degrees\n",
+         p->X/1000.0, p->Y/1000.0, degrees(p->Heading));
+  check((p->X >= 499000) && (p->X <= 501000), "quarter x um off", p->X - 500000);
+  check((p->Y >= 499000) && (p->Y <= 501000), "quarter y um off", p->Y - 500000);
+  check((degrees(p->Heading) >= 89.8) && (degrees(p->Heading) <= 90.2),
+        "quarter heading degrees", degrees(p->Heading));
+}
+
+// ------------laps------------
+// Three laps of a 500 mm radius circle in 3142 steps each, the wheels
+// really 147 mm apart, a marker at the start of each lap.  The
+// first lap reads 5% too much turn; the marker after it rescales
+// the gain, and laps 2 and 3 end at the origin.
+static void laps(void){
+  const struct Odometry_Pose *p = Odometry_Get();
+  int64_t lap = 3141593;         // um, 2 pi 500 mm
+  int64_t s;
+  int32_t n = 0, k;
+  double gain;
+  Odometry_Init(0, 0);
+  Odometry_Marker();             // the start line
+  for(k = 1; k <= 3; k++){
+    for(; n < k*3142; n++){      // the last step of each lap ends on the marker
+      s = (n + 1)*lap/3142;
+      Odometry_Update(edges(s*(500000 - 73500)/500000), edges(s*(500000 + 73500)/500000));
+    }
+    printf("lap %d x %.2f mm y %.2f mm heading %.2f degrees\n",
+           (int)k, p->X/1000.0, p->Y/1000.0, degrees(p->Heading));
+    if(k > 1){
+      check((p->X >= -2000) && (p->X <= 2000), "lap x um", p->X);
+      check((p->Y >= -2000) && (p->Y <= 2000), "lap y um", p->Y);
+    }
+    Odometry_Marker();
+  }
+  gain = (double)Odometry_Gain()/ODOMETRY_GAIN;
+  printf("gain %.4f of ODOMETRY_GAIN, 140/147 is %.4f\n", gain, 140.0/147);
+  check((gain > 140.0/147 - 0.002) && (gain < 140.0/147 + 0.002), "gain ratio", gain);
+}
+
+// ------------slip------------
+// 120 mm straight on the line to settle, then 2.4 m with the
+// right wheel gaining an edge every third step.
+static void slip(void){
+  const struct Odometry_Pose *p = Odometry_Get();
+  int32_t l = 0, r = 0, extra = 0, i;
+  Odometry_Init(0, 0);
+  for(i = 0; i < 20; i++){
+    l += 10;
+    r += 10;
+    Odometry_Line(0);
+    Odometry_Update(l, r);
+  }
+  for(i = 0; i < 400; i++){
+    l += 10;
+    r += 10;
+    if(i%3 == 0){
+      r++;
+      extra++;
+    }
+    Odometry_Line(0);
+    Odometry_Update(l, r);
+  }
+  printf("slip heading %.2f degrees drift %.2f degrees y %.2f mm\n",
+         degrees(p->Heading), degrees((uint32_t)Odometry_Drift()), p->Y/1000.0);
+  check(p->Heading == 0, "slip heading degrees", degrees(p->Heading));
+  check(Odometry_Drift() == (int32_t)((int64_t)extra*ODOMETRY_GAIN),
+        "slip drift degrees", degrees((uint32_t)Odometry_Drift()));
+  check(p->Y == 0, "slip y um", p->Y);
+}
+
+// ------------curve------------
+// A steady curve, 2380/km, centered on the line all the way.
+static void curve(void){
+  const struct Odometry_Pose *p = Odometry_Get();
+  int32_t l = 0, r = 0, i;
+  Odometry_Init(0, 0);
+  for(i = 0; i < 100; i++){
+    l += 10;
+    r += 14;
+    Odometry_Line(0);
+    Odometry_Update(l, r);
+  }
+  printf("curve k %d/km heading %.2f degrees drift %.2f degrees\n",
+         (int)Odometry_Curvature(), degrees(p->Heading), degrees((uint32_t)Odometry_Drift()));
+  check(Odometry_Drift() == 0, "curve drift degrees", degrees((uint32_t)Odometry_Drift()));
+  check(p->Heading == (uint32_t)(400*ODOMETRY_GAIN), "curve heading degrees", degrees(p->Heading));
+}
+
+int main(void){
+  quarter();
+  laps();
+  slip();
+  curve();
+  printf("odometry failures %u\n", Bad);
+  return Bad != 0;
+}
@@ -0,0 +1,45 @@
+// positiontest.c
+// Runs on the host
+// Exhaustive check of the Reflectance.c line position: for all
+// 256 sensor readings the table lookup (Reflectance_Position) and
+// the popcount version (Reflectance_PositionPopcount) must equal
+// the reference loop (Reflectance_PositionRef), and so must the
+// grey-level average (Reflectance_PositionLevels) given a level
+// of 1 for each black sensor.
+
+#include <stdio.h>
+#include <stdint.h>
+#include "Reflectance.h"
+
+int main(void){
+  uint8_t levels[8];
+  int32_t ref, table, popcount, grey;
+  uint32_t bad = 0;
+  int data, i;
+  for(data = 0; data < 256; data++){
+    for(i = 0; i < 8; i++){
+      levels[i] = (data >> i) & 0x01;
+    }
+    ref = Reflectance_PositionRef(data);
+    table = Reflectance_Position(data);
+    popcount = Reflectance_PositionPopcount(data);
+    grey = Reflectance_PositionLevels(levels);
+    if((table != ref) || (popcount != ref) || (grey != ref)){
+      if(bad < 10){
+        printf("0x%02X: reference %d table %d popcount %d levels %d\n",
+               data, ref, table, popcount, grey);
+      }
+      bad++;
+    }
+  }
+  if(Reflectance_Position(0x00) != REFLECTANCE_NOLINE){
+    printf("0x00 is not REFLECTANCE_NOLINE\n");
+    bad++;
+  }
+  if(Reflectance_Position(0x18) != 0){
+    printf("0x18, the two middle sensors, is not 0\n");
+    bad++;
+  }
+  printf("readings 256 mismatches %u\n", bad);
+  return bad != 0;
+}
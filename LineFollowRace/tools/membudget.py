@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""Per-module flash and SRAM budget report from the TI linker map.
+
+Reads the MODULE SUMMARY section of the map file written by the TI ARM
+linker and prints, for every object file, its flash use (code + ro
+data) and SRAM use (rw data) next to its budget.  Exits with status 1
+if any module, or the whole image, is over budget, so it can run as a
+post-build step.
+
+Budgets come from membudget.cfg next to this script unless --budget
+names another file.  Each line is
+
+    module   flash   sram
+
+in bytes, with "-" for no limit.  "*" sets the budget of every module
+not listed by name, "Stack:" is the linker's stack and heap reservation,
+and "TOTAL" is the whole image.
+
+usage: membudget.py [--budget FILE] [Debug/LineFollowRace.map]
+"""
+
+import argparse
+import os
+import re
+import sys
+
+ROW = re.compile(r'^\s+(\S.*?)\s+(\d+)\s+(\d+)\s+(\d+)\s*$')
+
+
+def read_summary(path):
+    """Return [(module, code, ro, rw)] and the grand total from a map file."""
+    modules = []
+    total = None
+    inside = False
+    with open(path, encoding='latin-1') as f:
+        for line in f:
+            if line.startswith('MODULE SUMMARY'):
+                inside = True
+                continue
+            if not inside:
+                continue
+            if line.startswith('LINKER GENERATED') or line.startswith('GLOBAL SYMBOLS'):
+                break
+            m = ROW.match(line)
+            if not m:
+                continue               # library paths, rules, blank lines
+            name = m.group(1)
+            code, ro, rw = (int(m.group(i)) for i in (2, 3, 4))
+            if name == 'Grand Total:':
+                total = (code, ro, rw)
+            elif name != 'Total:':
+                modules.append((name, code, ro, rw))
+    if total is None:
+        raise ValueError('%s has no MODULE SUMMARY' % path)
+    return modules, total
+
+
+def read_budget(path):
+    """Return {module: (flash, sram)}, None meaning no limit."""
+    budget = {}
+    with open(path) as f:
+        for n, line in enumerate(f, 1):
+            line = line.split('#', 1)[0].split()
+            if not line:
+                continue
+            if len(line) != 3:
+                raise ValueError('%s:%d: expected "module flash sram"' % (path, n))
+            budget[line[0]] = tuple(None if v == '-' else int(v, 0) for v in line[1:])
+    return budget
+
+
+def check(used, limit):
+    """Format one figure with its limit; True if it is over."""
+    if limit is None:
+        return '%7d %7s     ' % (used, '-'), False
+    over = used > limit
+    return '%7d %7d %3d%%%s' % (used, limit, 100 * used // max(limit, 1), '!' if over else ' '), over
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('map', nargs='?',
+                        default=os.path.join(here, '..', 'Debug', 'LineFollowRace.map'))
+    parser.add_argument('--budget', default=os.path.join(here, 'membudget.cfg'))
+    args = parser.parse_args()
+
+    modules, total = read_summary(args.map)
+    budget = read_budget(args.budget)
+    default = budget.get('*', (None, None))
+    failed = []
+
+    print('%-30s %7s %7s %5s %7s %7s %5s' % ('module', 'flash', 'budget', '', 'sram', 'budget', ''))
+    rows = modules + [('TOTAL', total[0], total[1], total[2])]
+    for name, code, ro, rw in rows:
+        flash_limit, sram_limit = budget.get(name, default)
+        flash, flash_over = check(code + ro, flash_limit)
+        sram, sram_over = check(rw, sram_limit)
+        print('%-30s %s %s' % (name, flash, sram))
+        if flash_over:
+            failed.append('%s flash' % name)
+        if sram_over:
+            failed.append('%s sram' % name)
+
+    if failed:
+        print('\nover budget: ' + ', '.join(failed))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,264 @@
+#!/usr/bin/env python3
+"""Lateral error against speed, fixed control periods against the governor.
+
+Drives a simulated robot round a track with the FSM from LineFollowRace.c
+(duties and next-state table read from the source) and the sensor
+conversion of read(), at a range of speeds.  Every duty in the table is
+multiplied by the speed factor, capped at +/-14998.  Each speed is run with
+the fixed periods given and with the rate governor of Rate.c, using the
+same bounds and distances as the rate.* parameters.
+
+The robot is a differential drive with the wheel speed lagging the duty
+(first order); a sensor is black while the line, 19 mm wide, lies under
+it.  The lateral error is the line's offset from the middle of the
+sensor bar.  A run fails when the FSM reaches Error, where the real robot
+would start the lost-line search.
+
+The track is a built-in loop of straights, a hairpin and an S bend, or a
+description written by trackrecon.py --json, so a real track can be
+replayed.  For every speed and policy the mean period, steps per second,
+RMS and largest error, and whether the lap was finished are printed:
+
+    duty  mm/s  policy     mean_us  steps/s  rms_mm  max_mm  lap
+   14998   500  fixed10      10000      100    13.7    26.3  ok
+   14998   500  governed      6532      153    13.5    26.4  ok
+
+In curves most of the error is the bar cutting inside the line, which
+no period removes; compare the largest error and the laps lost.
+
+usage: ratestudy.py [--track FILE] [--fixed 10000,4000] [--speeds 1,2,3,4,5]
+"""
+
+import argparse
+import json
+import math
+import os
+import re
+import sys
+
+WEIGHTS = (-33.4, -23.8, -14.3, -4.8, 4.8, 14.3, 23.8, 33.4)   # mm, sensor 0 on the right
+NOLINE = 33500                 # REFLECTANCE_NOLINE, um
+NAMES = ('Center', 'Left1', 'Left2', 'Left3', 'Right1', 'Right2', 'Right3', 'Stop', 'Error')
+STOP, ERROR = 7, 8
+
+
+def load_fsm(path):
+    """[(right_pwm, left_pwm, [next index for input 0-63])] from the fsm[] initializer."""
+    text = open(path).read()
+    body = text[text.index('struct State fsm['):]
+    body = body[:body.index('};')]
+    states = []
+    for right, left, nexts in re.findall(r'\{\s*(-?\d+),\s*(-?\d+),\s*\{([^}]*)\}\}', body):
+        names = [n.strip() for n in nexts.split(',')]
+        states.append((int(right), int(left), [NAMES.index(n) for n in names]))
+    if len(states) != len(NAMES):
+        sys.exit('could not read fsm[] from ' + path)
+    return states
+
+
+def read_input(data):
+    """read(): 8 sensor bits to the FSM's 6-bit input."""
+    return (((data & 0x01) | ((data & 0x02) >> 1)) |
+            ((data & 0x04) >> 1) | ((data & 0x08) >> 1) | ((data & 0x10) >> 1) |
+            ((data & 0x20) >> 1) | ((data & 0x40) >> 1) | ((data & 0x80) >> 2))
+
+
+def position(data):
+    """Reflectance_Position(), um."""
+    on = [w for bit, w in enumerate(WEIGHTS) if data & (1 << bit)]
+    return round(sum(on) / len(on) * 1000) if on else NOLINE
+
+
+class Governor:
+    """Rate_Step() from Rate.c."""
+
+    UP_US = 1000
+    TICK_US = 1000
+
+    def __init__(self, args):
+        self.min, self.max = args.rate_min, max(args.rate_max, args.rate_min)
+        self.travel, self.slew_um = args.rate_um, args.rate_slew
+        self.slew = 0
+        self.last = NOLINE
+
+    def step(self, us, speed, pos):
+        target = self.max
+        if pos == NOLINE:
+            target = self.min
+        elif self.last != NOLINE:
+            slew = abs(pos - self.last) * 1000 // us
+            if slew > self.slew:
+                self.slew += (slew - self.slew + 3) >> 2
+            else:
+                self.slew -= (self.slew - slew) >> 2
+        self.last = pos
+        if speed:
+            target = min(target, self.travel * 1000 // speed)
+        if self.slew:
+            target = min(target, self.slew_um * 1000 // self.slew)
+        target = min(target, us + self.UP_US, self.max)
+        target = max(target, self.min)
+        target -= target % self.TICK_US
+        return max(target, self.TICK_US)
+
+
+def track_points(segments, spacing):
+    """Line polyline, mm, starting at the origin heading along x."""
+    x = y = heading = 0.0
+    points = [(x, y)]
+    for seg in segments:
+        n = max(1, int(seg['length_mm'] / spacing))
+        ds = seg['length_mm'] / n
+        turn = math.radians(seg.get('turn_deg', 0.0)) / n if seg['type'] == 'arc' else 0.0
+        for _ in range(n):
+            heading += turn / 2
+            x += ds * math.cos(heading)
+            y += ds * math.sin(heading)
+            heading += turn / 2
+            points.append((x, y))
+    return points
+
+
+BUILT_IN = [
+    {'type': 'straight', 'length_mm': 1200},
+    {'type': 'arc', 'length_mm': 471, 'turn_deg': 180.0},      # r 150 hairpin
+    {'type': 'straight', 'length_mm': 400},
+    {'type': 'arc', 'length_mm': 314, 'turn_deg': -90.0},      # r 200 S bend
+    {'type': 'arc', 'length_mm': 314, 'turn_deg': 90.0},
+    {'type': 'straight', 'length_mm': 400},
+    {'type': 'arc', 'length_mm': 942, 'turn_deg': 180.0},      # r 300
+    {'type': 'straight', 'length_mm': 400},
+]
+
+
+class Robot:
+    """Differential drive on the line, mm, s and radians."""
+
+    def __init__(self, points, args):
+        self.points = points
+        self.args = args
+        x0, y0 = points[0]
+        x1, y1 = points[1]
+        self.heading = math.atan2(y1 - y0, x1 - x0)
+        # axle behind the start so the bar is on the line
+        self.x = x0 - args.sensor_ahead * math.cos(self.heading)
+        self.y = y0 - args.sensor_ahead * math.sin(self.heading)
+        self.vl = self.vr = 0.0
+        self.index = 0
+
+    def offset(self):
+        """Line offset from the middle of the bar, mm, positive to the left."""
+        c, s = math.cos(self.heading), math.sin(self.heading)
+        bx, by = self.x + self.args.sensor_ahead * c, self.y + self.args.sensor_ahead * s
+        best, where = None, self.index
+        for i in range(max(0, self.index - 20), min(len(self.points), self.index + 60)):
+            px, py = self.points[i]
+            d = (px - bx) ** 2 + (py - by) ** 2
+            if best is None or d < best:
+                best, where = d, i
+        self.index = where
+        px, py = self.points[where]
+        return -(px - bx) * s + (py - by) * c, where
+
+    def sensors(self, offset):
+        half = self.args.line_width / 2
+        data = 0
+        for bit, w in enumerate(WEIGHTS):
+            if abs(w - offset) < half:
+                data |= 1 << bit
+        return data
+
+    def move(self, left, right, dt):
+        a = dt / self.args.tau
+        self.vl += (left / 14998.0 * self.args.top_speed - self.vl) * a
+        self.vr += (right / 14998.0 * self.args.top_speed - self.vr) * a
+        turn = (self.vr - self.vl) * dt / self.args.base
+        mid = self.heading + turn / 2
+        ds = (self.vl + self.vr) / 2 * dt
+        self.x += ds * math.cos(mid)
+        self.y += ds * math.sin(mid)
+        self.heading += turn
+
+
+def run(fsm, points, factor, fixed, args):
+    """One lap; fixed is the period in us, or 0 for the governor."""
+    robot = Robot(points, args)
+    governor = Governor(args)
+    state = 0
+    period = fixed or args.rate_max
+    t = 0.0
+    due = 0.0
+    left = right = 0
+    steps = 0
+    total_us = 0
+    squares = 0.0
+    worst = 0.0
+    samples = 0
+    dt = args.dt / 1e6
+    while t < args.timeout:
+        offset, where = robot.offset()
+        if t >= due:
+            data = robot.sensors(offset)
+            state = fsm[state][2][read_input(data)]
+            if state in (STOP, ERROR):
+                return total_us / max(steps, 1), steps / max(t, dt), squares, worst, samples, False
+            right = max(-14998, min(14998, round(fsm[state][0] * factor)))
+            left = max(-14998, min(14998, round(fsm[state][1] * factor)))
+            speed = round((abs(left) + abs(right)) * args.top_speed / (2 * 14998))
+            chosen = governor.step(period, speed, position(data))
+            period = fixed or chosen
+            steps += 1
+            total_us += period
+            due += period / 1e6
+        if where >= len(points) - 1:
+            return total_us / steps, steps / t, squares, worst, samples, True
+        squares += offset * offset
+        worst = max(worst, abs(offset))
+        samples += 1
+        robot.move(left, right, dt)
+        t += dt
+    return total_us / max(steps, 1), steps / max(t, dt), squares, worst, samples, False
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--source', default=os.path.join(here, '..', 'LineFollowRace.c'), help='where fsm[] is')
+    parser.add_argument('--track', help='track description from trackrecon.py --json')
+    parser.add_argument('--speeds', default='1,1.5,2,2.5,3,3.5,4,4.5,5', help='duty multipliers to run')
+    parser.add_argument('--fixed', default='10000,4000', help='fixed periods to compare, us')
+    parser.add_argument('--rate-min', type=int, default=4000, help='as rate.min, us')
+    parser.add_argument('--rate-max', type=int, default=20000, help='as rate.max, us')
+    parser.add_argument('--rate-um', type=int, default=3000, help='as rate.um')
+    parser.add_argument('--rate-slew', type=int, default=3000, help='as rate.slew, um')
+    parser.add_argument('--top-speed', type=float, default=500, help='mm/s at full duty')
+    parser.add_argument('--tau', type=float, default=0.04, help='s, wheel speed lag behind the duty')
+    parser.add_argument('--base', type=float, default=140, help='mm between the wheels')
+    parser.add_argument('--sensor-ahead', type=float, default=70, help='mm from the axle to the sensor bar')
+    parser.add_argument('--line-width', type=float, default=19, help='mm')
+    parser.add_argument('--dt', type=float, default=250, help='simulation step, us')
+    parser.add_argument('--timeout', type=float, default=120, help='s, longest lap')
+    args = parser.parse_args()
+
+    fsm = load_fsm(args.source)
+    segments = BUILT_IN
+    if args.track:
+        with open(args.track) as f:
+            segments = json.load(f)['segments']
+    points = track_points(segments, 2.0)
+    policies = [('fixed%d' % (us // 1000), us) for us in map(int, args.fixed.split(','))]
+    policies.append(('governed', 0))
+
+    print('duty  mm/s  policy     mean_us  steps/s  rms_mm  max_mm  lap')
+    for factor in map(float, args.speeds.split(',')):
+        duty = min(14998, round(fsm[0][0] * factor))
+        for name, us in policies:
+            mean, rate, squares, worst, samples, done = run(fsm, points, factor, us, args)
+            rms = math.sqrt(squares / samples) if samples else 0.0
+            print('%5d %5d  %-9s %8d %8.0f %7.1f %7.1f  %s' % (
+                duty, duty * args.top_speed / 14998, name, mean, rate, rms, worst,
+                'ok' if done else 'lost'))
+
+
+if __name__ == '__main__':
+    main()
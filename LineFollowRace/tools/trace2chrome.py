@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+"""Turn a Trace.h buffer saved from the target into a Chrome trace.
+
+Build with TRACE defined, arm with the "trace" shell command, run a lap,
+then save the Trace variable with the debugger (Memory Browser, Save
+Memory, from &Trace for sizeof(Trace) bytes) as raw binary or as TI data
+format.  This script reads either and writes JSON in the Chrome trace
+event format, which chrome://tracing and ui.perfetto.dev both open:
+
+    control   each step, with the stages it went through inside it
+    tasks     which task the kernel switched to, idle included
+    ISRs      each interrupt from entry to exit, nested as they preempt
+
+It also prints a summary: how long each stage and ISR took, how regular
+the steps were, and how much of the lap the processor spent idle.
+
+usage: trace2chrome.py [--tasks idle,control,...] dump.bin [trace.json]
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = 0x54524331
+HEADER = 5                         # Magic, Hz, Mask, Count, Lost
+GAP = 0x7F
+ENDBIT = 0x80
+
+# Trace.h enum Trace_Id
+STAGE, TASK, STEP = 0, 8, 16
+ISRS = {17: 'SysTick', 18: 'TA3_0 right encoder', 19: 'TA3_N left encoder',
+        20: 'PORT4 bump', 21: 'EUSCIA0 UART', 22: 'WDT_A', 23: 'TA2 sample'}
+# LineFollowRace.c enum Stage; stage 0 is between steps and is not drawn
+STAGES = ('wait', 'events', 'odometry', 'drive', 'sense', 'next')
+
+
+def words(path):
+    """The saved memory as 32-bit words, from raw binary or TI data format."""
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data.startswith(b'1651'):   # TI data: a header line, then one 0x word per line
+        out = []
+        for token in data.decode('ascii', 'replace').split('\n', 1)[-1].split():
+            if token.lower().startswith('0x'):
+                out.append(int(token, 16))
+        return out
+    return list(struct.unpack_from('<%dI' % (len(data) // 4), data))
+
+
+def events(buf):
+    """Yield (cycles since the first event, code) from a Trace_Buffer."""
+    count = min(buf[3], len(buf) - HEADER)
+    t = 0
+    gap = 0
+    last = None
+    for w in buf[HEADER:HEADER + count]:
+        code, low = w >> 24, w & 0xFFFFFF
+        if code == GAP:
+            gap += low << 24
+            continue
+        if last is not None:
+            t += gap + ((low - last) & 0xFFFFFF)
+        gap = 0
+        last = low
+        yield t, code
+
+
+class Stats:
+    """Count, total and extremes of a set of durations, in us."""
+
+    def __init__(self):
+        self.n = 0
+        self.total = 0.0
+        self.low = float('inf')
+        self.high = 0.0
+
+    def add(self, us):
+        self.n += 1
+        self.total += us
+        self.low = min(self.low, us)
+        self.high = max(self.high, us)
+
+    def line(self, name):
+        return '  %-22s %7d %9.1f %9.1f %9.1f' % (name, self.n, self.low, self.total / self.n, self.high)
+
+
+def convert(buf, tasks):
+    """Chrome trace events and a summary for one Trace_Buffer."""
+    hz = buf[1]
+    us = lambda cycles: cycles * 1e6 / hz
+    out = [{'ph': 'M', 'pid': 1, 'name': 'process_name', 'args': {'name': 'MSP432'}}]
+    for tid, name in ((1, 'control'), (2, 'tasks'), (3, 'ISRs')):
+        out.append({'ph': 'M', 'pid': 1, 'tid': tid, 'name': 'thread_name', 'args': {'name': name}})
+        out.append({'ph': 'M', 'pid': 1, 'tid': tid, 'name': 'thread_sort_index', 'args': {'sort_index': tid}})
+
+    def slice(tid, name, begin, end):
+        out.append({'ph': 'X', 'pid': 1, 'tid': tid, 'name': name,
+                    'ts': round(us(begin), 3), 'dur': round(us(end - begin), 3)})
+
+    stats = {}
+    def note(name, begin, end):
+        stats.setdefault(name, Stats()).add(us(end - begin))
+
+    step = None                    # start of the step in progress
+    steps = []                     # start of every step
+    stage = None                   # (name, start) of the stage in progress
+    task = None                    # (name, start) of the running task
+    isr = {}                       # code: starts of ISRs in progress, nested
+    idle = 0
+    t = 0
+    for t, code in events(buf):
+        end = code & ENDBIT
+        code &= ~ENDBIT
+        if code < TASK:
+            if stage:
+                slice(1, stage[0], stage[1], t)
+                note(stage[0], stage[1], t)
+            name = STAGES[code] if code < len(STAGES) else 'stage %d' % code
+            stage = (name, t) if code and step is not None else None
+        elif code < STEP:
+            if task:
+                slice(2, task[0], task[1], t)
+                if task[0] == tasks[0]:
+                    idle += t - task[1]
+            n = code - TASK
+            task = (tasks[n] if n < len(tasks) else 'task %d' % n, t)
+        elif code == STEP:
+            if not end:
+                step = t
+                steps.append(t)
+            elif step is not None:
+                if stage:
+                    slice(1, stage[0], stage[1], t)
+                    note(stage[0], stage[1], t)
+                    stage = None
+                slice(1, 'step', step, t)
+                note('step', step, t)
+                step = None
+        else:
+            name = ISRS.get(code, 'code %d' % code)
+            if not end:
+                isr.setdefault(code, []).append(t)
+            elif isr.get(code):
+                begin = isr[code].pop()
+                slice(3, name, begin, t)
+                note(name, begin, t)
+    if task:                       # the last one runs to the end of the trace
+        slice(2, task[0], task[1], t)
+        if task[0] == tasks[0]:
+            idle += t - task[1]
+
+    summary = ['%d us traced, %d words, %d events lost' % (us(t), min(buf[3], len(buf) - HEADER), buf[4])]
+    if buf[4]:
+        summary.append('the buffer filled before the lap ended; narrow trace.mask or raise TRACE_SIZE')
+    summary.append('\n  %-22s %7s %9s %9s %9s' % ('us', 'count', 'min', 'mean', 'max'))
+    order = ['step'] + list(STAGES) + sorted(set(ISRS.values()))
+    for name in order + sorted(set(stats) - set(order)):
+        if name in stats:
+            summary.append(stats[name].line(name))
+    if len(steps) > 2:
+        period = Stats()
+        for a, b in zip(steps, steps[1:]):
+            period.add(us(b - a))
+        summary.append(period.line('step period'))
+        summary.append('  step jitter %.1f us peak to peak' % (period.high - period.low))
+    if task is not None and t:
+        summary.append('  idle %.1f%% of the time' % (100.0 * idle / t))
+    return out, summary
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('dump', help='Trace saved with the debugger, raw binary or TI data format')
+    parser.add_argument('json', nargs='?', help='Chrome trace to write, default the dump name with .json')
+    parser.add_argument('--tasks', default='idle,control,shell,telemetry',
+                        help='task names in OS_AddTask order, the idle task first')
+    args = parser.parse_args()
+
+    buf = words(args.dump)
+    if len(buf) < HEADER or buf[0] != MAGIC:
+        print('%s does not start with a Trace buffer' % args.dump)
+        return 1
+    if buf[3] == 0:
+        print('the trace is empty; was it armed before a lap?')
+        return 1
+    trace, summary = convert(buf, args.tasks.split(','))
+    name = args.json or args.dump.rsplit('.', 1)[0] + '.json'
+    with open(name, 'w') as f:
+        json.dump({'traceEvents': trace, 'displayTimeUnit': 'ns'}, f)
+    print('\n'.join(summary))
+    print('\nwrote %s, open it in ui.perfetto.dev or chrome://tracing' % name)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,266 @@
+#!/usr/bin/env python3
+"""Rebuild the track shape from a binary log of a run.
+
+Reads a capture of UART0 with telem set to 2 (Log.h frames) and rebuilds
+the path of the line.  The robot's own path comes from dead reckoning on
+the encoder counts, or from the commanded duties when the encoders did
+not move (a robot without encoders, or a log from the simulator).  The
+line position under the sensor bar is then added to it: the line is
+offset sideways from the robot by the weighted mean of the black
+sensors, at the bar's distance ahead of the axle.  That fusion removes
+the robot's own weaving, so what is left is the track.
+
+The line path is split into laps at the start/finish marker (every
+sensor black), resampled by distance, smoothed to take out the steps of
+the eight sensors, and cut into straights and arcs by its curvature.
+The result is printed and, with --json, written in the form the
+simulator and the speed planner read:
+
+    {"lap": 2, "length_mm": 5230, "closure_mm": 41,
+     "segments": [{"type": "straight", "length_mm": 812},
+                  {"type": "arc", "length_mm": 640, "radius_mm": 410,
+                   "turn_deg": -89.4}, ...]}
+
+The log is read through mmap and decoded one frame at a time, and only
+the lap in progress is kept, so memory does not grow with the length of
+the log.  Frames with a bad checksum are skipped by searching for the
+next sync.
+
+usage: trackrecon.py [--lap N] [--json FILE] log.bin
+"""
+
+import argparse
+import json
+import math
+import mmap
+import struct
+import sys
+
+SYNC = b'\xa5\x5a'
+FRAME = struct.Struct('<2sHIBBhhii')     # Log.h, without the checksum byte
+SIZE = FRAME.size + 1
+
+# Reflectance.c sensor weights, um from the centre of the bar, sensor 0 first
+WEIGHTS = (-33400, -23800, -14300, -4800, 4800, 14300, 23800, 33400)
+OFFSET = [None] * 256
+for data in range(1, 255):
+    on = [w for bit, w in enumerate(WEIGHTS) if data & (1 << bit)]
+    OFFSET[data] = sum(on) / len(on) / 1000.0  # mm, None for no line or the marker
+
+
+def frames(path):
+    """Yield (seq, ms, sensors, state, left, right, lcount, rcount)."""
+    with open(path, 'rb') as f:
+        try:
+            m = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        except ValueError:         # empty file
+            return
+        with m:
+            pos = m.find(SYNC)
+            end = len(m) - SIZE
+            while 0 <= pos <= end:
+                if sum(m[pos + 2:pos + SIZE - 1]) & 0xFF == m[pos + SIZE - 1]:
+                    yield FRAME.unpack_from(m, pos)[1:]
+                    pos += SIZE
+                else:
+                    pos += 1
+                pos = m.find(SYNC, pos)
+
+
+class Reckoner:
+    """Differential-drive dead reckoning, mm and radians."""
+
+    def __init__(self, args):
+        self.args = args
+        self.x = self.y = self.heading = 0.0
+        self.last = None
+
+    def step(self, ms, left, right, lcount, rcount):
+        """Advance by one frame and return the distance moved."""
+        if self.last is None:
+            self.last = (ms, lcount, rcount)
+            return 0.0
+        ms0, l0, r0 = self.last
+        self.last = (ms, lcount, rcount)
+        dl = (lcount - l0) * self.args.um_per_edge / 1000.0
+        dr = (rcount - r0) * self.args.um_per_edge / 1000.0
+        if dl == 0 and dr == 0 and (left or right):
+            dt = ((ms - ms0) & 0xFFFFFFFF) / 1000.0
+            dl = left / 14998.0 * self.args.top_speed * dt
+            dr = right / 14998.0 * self.args.top_speed * dt
+        turn = (dr - dl) / self.args.base
+        mid = self.heading + turn / 2
+        ds = (dl + dr) / 2
+        self.x += ds * math.cos(mid)
+        self.y += ds * math.sin(mid)
+        self.heading += turn
+        return abs(ds)
+
+    def line_point(self, sensors):
+        """Where the line is, or None if this reading does not show it."""
+        offset = OFFSET[sensors]
+        if offset is None:
+            return None
+        ahead = self.args.sensor_ahead
+        c, s = math.cos(self.heading), math.sin(self.heading)
+        # sensor 0 is on the robot's right, so positive offsets are to its left
+        return (self.x + ahead * c - offset * s, self.y + ahead * s + offset * c)
+
+
+def resample(points, spacing):
+    """Points every spacing mm along a polyline."""
+    if not points:
+        return []
+    out = [points[0]]
+    carry = 0.0
+    for (x0, y0), (x1, y1) in zip(points, points[1:]):
+        d = math.hypot(x1 - x0, y1 - y0)
+        t = spacing - carry
+        while t <= d:
+            out.append((x0 + (x1 - x0) * t / d, y0 + (y1 - y0) * t / d))
+            t += spacing
+        carry = d - (t - spacing)
+    return out
+
+
+def smooth(points, span, spacing):
+    """Centred moving average over span mm, to take out sensor steps."""
+    half = int(span / spacing / 2)
+    if half < 1 or len(points) < 3:
+        return points
+    xs = [0.0]
+    ys = [0.0]
+    for x, y in points:                # running sums
+        xs.append(xs[-1] + x)
+        ys.append(ys[-1] + y)
+    out = []
+    for i in range(len(points)):
+        a, b = max(0, i - half), min(len(points), i + half + 1)
+        out.append(((xs[b] - xs[a]) / (b - a), (ys[b] - ys[a]) / (b - a)))
+    return out
+
+
+def segments(points, args):
+    """Cut a resampled path into straights and arcs."""
+    n = len(points)
+    if n < 3:
+        return []
+    headings = [math.atan2(y1 - y0, x1 - x0) for (x0, y0), (x1, y1) in zip(points, points[1:])]
+    for i in range(1, len(headings)):   # unwrap
+        d = headings[i] - headings[i - 1]
+        headings[i] -= round(d / (2 * math.pi)) * 2 * math.pi
+    half = max(1, int(args.window / args.spacing / 2))
+    kinds = []
+    for i in range(len(headings)):
+        a, b = max(0, i - half), min(len(headings) - 1, i + half)
+        k = (headings[b] - headings[a]) / ((b - a) * args.spacing) * 1000 if b > a else 0.0
+        kinds.append(0 if abs(k) < args.straight else (1 if k > 0 else -1))
+
+    runs = []                      # [kind, first, last] over headings
+    for i, kind in enumerate(kinds):
+        if runs and runs[-1][0] == kind:
+            runs[-1][2] = i
+        else:
+            runs.append([kind, i, i])
+    shortest = max(1, int(args.min_length / args.spacing))
+    while len(runs) > 1:           # fold the shortest run into its longer neighbour
+        j = min(range(len(runs)), key=lambda r: runs[r][2] - runs[r][1])
+        kind, a, b = runs[j]
+        if b - a + 1 >= shortest:
+            break
+        left = runs[j - 1] if j > 0 else None
+        right = runs[j + 1] if j + 1 < len(runs) else None
+        into = left if right is None or (left and left[2] - left[1] >= right[2] - right[1]) else right
+        into[1], into[2] = min(into[1], a), max(into[2], b)
+        del runs[j]
+        i = 1
+        while i < len(runs):
+            if runs[i][0] == runs[i - 1][0]:
+                runs[i - 1][2] = runs[i][2]
+                del runs[i]
+            else:
+                i += 1
+
+    out = []
+    for kind, a, b in runs:
+        length = (b - a + 1) * args.spacing
+        if kind == 0:
+            out.append({'type': 'straight', 'length_mm': round(length)})
+        else:
+            turn = headings[b] - headings[a] if b > a else 0.0
+            radius = length / abs(turn) if turn else float('inf')
+            out.append({'type': 'arc', 'length_mm': round(length),
+                        'radius_mm': round(radius), 'turn_deg': round(math.degrees(turn), 1)})
+    return out
+
+
+def laps(path, args):
+    """Yield (lap number, [line points]) for each lap between markers."""
+    robot = Reckoner(args)
+    points = []
+    lap = 0
+    held = 0
+    travel = 0.0
+    for seq, ms, sensors, state, left, right, lcount, rcount in frames(path):
+        travel += robot.step(ms, left, right, lcount, rcount)
+        if sensors == 0xFF:
+            held += 1
+            if held == args.hold:
+                if lap:
+                    yield lap, points
+                lap += 1
+                points = []
+            continue
+        held = 0
+        point = robot.line_point(sensors)
+        if lap and point and (not points or travel >= args.spacing / 2):
+            points.append(point)
+            travel = 0.0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('log', help='binary capture of UART0 with telem 2')
+    parser.add_argument('--lap', type=int, default=0, help='lap to describe, default the last complete one')
+    parser.add_argument('--json', help='write the track description here')
+    parser.add_argument('--um-per-edge', type=float, default=611, help='wheel travel per encoder edge')
+    parser.add_argument('--base', type=float, default=140, help='mm between the wheels')
+    parser.add_argument('--sensor-ahead', type=float, default=70, help='mm from the axle to the sensor bar')
+    parser.add_argument('--top-speed', type=float, default=500, help='mm/s at full duty, when there are no encoder counts')
+    parser.add_argument('--hold', type=int, default=3, help='all-black samples that make the marker, as lap.hold')
+    parser.add_argument('--spacing', type=float, default=10, help='mm between resampled points')
+    parser.add_argument('--smooth', type=float, default=100, help='mm of line path averaged, for sensor noise')
+    parser.add_argument('--window', type=float, default=100, help='mm over which curvature is measured')
+    parser.add_argument('--straight', type=float, default=0.8, help='curvature below this, 1/m, is straight')
+    parser.add_argument('--min-length', type=float, default=80, help='shortest segment, mm')
+    args = parser.parse_args()
+
+    chosen = None
+    chosen_path = []
+    for number, points in laps(args.log, args):
+        path = resample(smooth(resample(points, args.spacing), args.smooth, args.spacing), args.spacing)
+        length = (len(path) - 1) * args.spacing if path else 0
+        closure = math.hypot(path[-1][0] - path[0][0], path[-1][1] - path[0][1]) if path else 0
+        print('lap %d: %d mm, ends %d mm from its start' % (number, length, closure))
+        if args.lap in (0, number):
+            chosen = {'lap': number, 'length_mm': round(length), 'closure_mm': round(closure)}
+            chosen_path = path
+    if chosen is None:
+        print('no complete lap%s in %s' % ('' if not args.lap else ' %d' % args.lap, args.log))
+        return 1
+    chosen['segments'] = segments(chosen_path, args)
+
+    print('\nlap %d track:' % chosen['lap'])
+    for s in chosen['segments']:
+        if s['type'] == 'straight':
+            print('  straight %5d mm' % s['length_mm'])
+        else:
+            print('  arc      %5d mm  radius %5s mm  %+7.1f deg' % (s['length_mm'], s['radius_mm'], s['turn_deg']))
+    if args.json:
+        with open(args.json, 'w') as f:
+            json.dump(chosen, f, indent=1)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())